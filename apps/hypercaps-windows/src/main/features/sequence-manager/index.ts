@@ -32,6 +32,7 @@
  * Enjoy the advanced solution—no baby stuff here. ;)
  */
 
+import type { MoveConfig, MoveEvent } from '@hypercaps/keyboard-monitor'
 import { EventEmitter } from 'events'
 import { keyboardService } from '../../service/keyboard/keyboard-service'
 import type { KeyboardFrameEvent } from '../../service/keyboard/types'
@@ -104,6 +105,12 @@ export class SequenceManager extends EventEmitter {
       this.update(frameEvent.timestamp)
     })
 
+    // Speculative results from the native recognizer arrive ahead of the frame
+    keyboardService.on('keyboard:move', (moveEvent: MoveEvent) => {
+      if (!this.config.isEnabled) return
+      this.handleNativeMove(moveEvent)
+    })
+
     console.log('[SequenceManager] Initialized. Buffer window =', this.bufferWindowMs, 'ms')
   }
 
@@ -113,6 +120,61 @@ export class SequenceManager extends EventEmitter {
    */
   public addMove(move: MoveDefinition) {
     this.moves.push(move)
+    if (!this.isNativeMove(move)) {
+      console.log(
+        `[SequenceManager] Move "${move.name}" has hitConfirm or keyless steps; ` +
+          'it is only recognized from frames (no move:start/confirm/cancel)'
+      )
+    }
+    keyboardService.setMoves(this.getNativeMoves())
+  }
+
+  /**
+   * Whether the native recognizer can run a move; hitConfirm steps need game state
+   * it doesn't have, and it matches steps by key. Other moves stay frame-only.
+   */
+  private isNativeMove(move: MoveDefinition): boolean {
+    return move.steps.every((step) => step.type !== 'hitConfirm' && step.keys?.length)
+  }
+
+  private getNativeMoves(): MoveConfig[] {
+    return this.moves
+      .filter((move) => this.isNativeMove(move))
+      .map((move) => ({
+        name: move.name,
+        steps: move.steps.map((step) => ({
+          type: step.type as 'press' | 'hold',
+          keys: step.keys ?? [],
+          minHoldMs: step.minHoldMs,
+          maxHoldMs: step.maxHoldMs,
+          maxGapMs: step.maxGapMs,
+          multiPressToleranceMs: step.multiPressToleranceMs,
+          completeOnReleaseAfterMinHold: step.completeOnReleaseAfterMinHold
+        }))
+      }))
+  }
+
+  /**
+   * start fires on the completing transition; confirm or cancel follows once
+   * the speculation window closes. Frame-based move:complete is unaffected.
+   */
+  private handleNativeMove({ name, phase, timestamp }: MoveEvent) {
+    const move = this.moves.find((m) => m.name === name)
+    if (!move) return
+
+    switch (phase) {
+      case 'start':
+        move.onStart?.()
+        this.emit('move:start', { name, timestamp })
+        break
+      case 'confirm':
+        this.emit('move:confirm', { name, timestamp })
+        break
+      case 'cancel':
+        move.onCancel?.()
+        this.emit('move:cancel', { name, timestamp })
+        break
+    }
   }
 
   /**
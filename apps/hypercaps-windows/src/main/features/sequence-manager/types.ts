@@ -71,12 +71,16 @@ export interface MoveStep {
 /**
  * A single move definition: "Hadouken", "QCF", "Sonic Boom" etc.
  * onComplete / onFail are optional callbacks.
+ * onStart / onCancel fire from native speculative recognition: onStart as soon
+ * as the final transition lands, onCancel if later input rolls it back.
  */
 export interface MoveDefinition {
   name: string
   steps: MoveStep[]
   onComplete?: () => void
   onFail?: () => void
+  onStart?: () => void
+  onCancel?: () => void
 }
 
 /**
@@ -96,4 +100,7 @@ export interface ActiveMoveState {
 export interface SequenceManagerEvents {
   'move:complete': { name: string }
   'move:fail': { name: string; reason: string; step: number }
+  'move:start': { name: string; timestamp: number }
+  'move:confirm': { name: string; timestamp: number }
+  'move:cancel': { name: string; timestamp: number }
 }
@@ -1,6 +1,15 @@
-import { KeyboardMonitor, type KeyboardFrame } from '@hypercaps/keyboard-monitor'
-import { dialog } from 'electron'
+import {
+  KeyboardMonitor,
+  type ChordEvent,
+  type HoldEvent,
+  type KeyboardConfig,
+  type KeyboardFrame,
+  type MoveConfig,
+  type MoveEvent
+} from '@hypercaps/keyboard-monitor'
+import { app, dialog } from 'electron'
 import { EventEmitter } from 'events'
+import { join } from 'path'
 import { keyboardStore } from './store'
 import { ErrorState, KeyboardFrameEvent, KeyboardServiceState, StateChangeEvent } from './types'
 import { processFrame } from './utils/frame-utils'
@@ -17,6 +26,8 @@ export class KeyboardService extends EventEmitter {
     lastError: undefined
   }
   private config = keyboardStore.get()
+  private moves: MoveConfig[] = []
+  private isMovesFlushPending = false
 
   private constructor() {
     super()
@@ -107,16 +118,22 @@ export class KeyboardService extends EventEmitter {
     })
 
     try {
-      const config = createMonitorConfig(this.config)
+      const config = this.buildMonitorConfig()
       console.log('KeyboardMonitor config:', config)
 
-      this.keyboardMonitor = new KeyboardMonitor((eventName: string, data: KeyboardFrame) => {
+      this.keyboardMonitor = new KeyboardMonitor((eventName, data) => {
         if (eventName === 'frame') {
           this.handleKeyboardFrame(data)
+        } else if (eventName === 'hold') {
+          this.handleHoldEvent(data)
+        } else if (eventName === 'chord') {
+          this.handleChordEvent(data)
+        } else if (eventName === 'move') {
+          this.handleMoveEvent(data)
         }
       })
 
-      this.keyboardMonitor.setConfig(config)
+      this.applyMonitorConfig(config)
       this.keyboardMonitor.start()
 
       this.setState({
@@ -180,10 +197,43 @@ export class KeyboardService extends EventEmitter {
     }
   }
 
+  private buildMonitorConfig(): KeyboardConfig {
+    return { ...createMonitorConfig(this.config), moves: this.moves }
+  }
+
   private updateMonitorConfig(): void {
     if (!this.keyboardMonitor) return
-    const config = createMonitorConfig(this.config)
-    this.keyboardMonitor.setConfig(config)
+    this.applyMonitorConfig(this.buildMonitorConfig())
+  }
+
+  /**
+   * Applies config through the compiled-config cache, so unchanged configs
+   * skip parsing and validation on the next start
+   */
+  private applyMonitorConfig(config: KeyboardConfig): void {
+    if (!this.keyboardMonitor) return
+    const cacheDir = join(app.getPath('userData'), 'keyboard-config-cache')
+    const { fromCache, errors } = this.keyboardMonitor.applyConfig(config, cacheDir)
+
+    if (errors.length) {
+      console.warn('[KeyboardService] Remap validation errors:', errors.map((e) => e.message))
+    }
+    console.log('[KeyboardService] Monitor config applied', fromCache ? 'from cache' : 'from source')
+  }
+
+  /**
+   * Replaces the moves recognized natively; results arrive as 'keyboard:move'.
+   * Calls made in the same tick (one per registered move at startup) are
+   * applied, and cached, once with the last list.
+   */
+  public setMoves(moves: MoveConfig[]): void {
+    this.moves = moves
+    if (this.isMovesFlushPending) return
+    this.isMovesFlushPending = true
+    queueMicrotask(() => {
+      this.isMovesFlushPending = false
+      this.updateMonitorConfig()
+    })
   }
 
   private handleKeyboardFrame = (data: KeyboardFrame): void => {
@@ -198,6 +248,25 @@ export class KeyboardService extends EventEmitter {
     }
   }
 
+  private handleHoldEvent = (data: HoldEvent): void => {
+    this.emit('keyboard:hold', data)
+  }
+
+  private handleChordEvent = (data: ChordEvent): void => {
+    this.emit('keyboard:chord', data)
+  }
+
+  private handleMoveEvent = (data: MoveEvent): void => {
+    this.emit('keyboard:move', data)
+  }
+
+  /**
+   * Milliseconds the key has been held, or -1 if it is not held or the monitor is stopped
+   */
+  public getHoldDuration(key: string): number {
+    return this.keyboardMonitor?.getHoldDuration(key) ?? -1
+  }
+
   public dispose(): void {
     console.log('[KeyboardService] Disposing service...')
     this.stopListening()
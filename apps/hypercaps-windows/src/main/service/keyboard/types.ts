@@ -1,4 +1,4 @@
-import { KeyboardFrame } from '@hypercaps/keyboard-monitor'
+import { ChordEvent, HoldEvent, KeyboardFrame, MoveEvent } from '@hypercaps/keyboard-monitor'
 
 export interface ErrorState {
   message: string
@@ -43,6 +43,9 @@ export interface StateChangeEvent {
 
 export type KeyboardEventMap = {
   'keyboard:frame': KeyboardFrameEvent
+  'keyboard:hold': HoldEvent
+  'keyboard:chord': ChordEvent
+  'keyboard:move': MoveEvent
   'keyboard:error': ErrorState
   'keyboard:state': StateChangeEvent
 }
@@ -6,7 +6,15 @@
       "cflags_cc!": [ "-fno-exceptions" ],
       "sources": [ 
         "src/keyboard_monitor.cc",
-        "src/key_mapping.cc"
+        "src/key_mapping.cc",
+        "src/key_names.cc",
+        "src/hold_timers.cc",
+        "src/key_state_table.cc",
+        "src/pipeline_stages.cc",
+        "src/trace_events.cc",
+        "src/chord_matcher.cc",
+        "src/move_recognizer.cc",
+        "src/compiled_config.cc"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
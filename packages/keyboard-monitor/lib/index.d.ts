@@ -1,10 +1,40 @@
-import type { KeyboardConfig, KeyboardFrame } from './types/keyboard';
+import type { ConfigApplyResult, KeyboardConfig, KeyboardEventArgs, PipelineStageStats } from './types/keyboard';
 export * from './types/keyboard';
-export type KeyboardEventCallback = (eventName: string, data: KeyboardFrame) => void;
+export type KeyboardEventCallback = (...args: KeyboardEventArgs) => void;
 export declare class KeyboardMonitor {
     private monitor;
     constructor(callback: KeyboardEventCallback);
     start(): void;
     stop(): void;
     setConfig(config: KeyboardConfig): void;
+    /**
+     * Milliseconds the key has been held, or -1 if it is not currently held
+     */
+    getHoldDuration(key: string): number;
+    /**
+     * Per-stage throughput counters, in pipeline order
+     */
+    getPipelineStats(): PipelineStageStats[];
+    /**
+     * Writes recorded spans as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+     * Requires `tracing: true` in the config; returns false if the file can't be written.
+     */
+    writeTrace(path: string): boolean;
+    /**
+     * Writes the monitor's current effective config as a compiled binary image
+     */
+    saveCompiledConfig(path: string, hash: string): boolean;
+    /**
+     * Maps a compiled image and applies it; false if it is missing, stale or damaged
+     */
+    loadCompiledConfig(path: string, hash: string): boolean;
+    /**
+     * Applies a complete config through an on-disk cache of compiled images.
+     * A hit maps the image compiled last time and skips parsing and validation;
+     * a miss validates remaps, replaces the whole config and caches the result.
+     * Fields the config leaves out go back to their defaults either way, so a
+     * hit and a miss end in the same state. Configs with remap errors are
+     * still applied but never cached.
+     */
+    applyConfig(config: KeyboardConfig, cacheDir: string): ConfigApplyResult;
 }
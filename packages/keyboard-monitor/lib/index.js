@@ -19,8 +19,14 @@ var __importDefault = (this && this.__importDefault) || function (mod) {
 Object.defineProperty(exports, "__esModule", { value: true });
 exports.KeyboardMonitor = void 0;
 const bindings_1 = __importDefault(require("bindings"));
+const crypto_1 = require("crypto");
+const fs_1 = require("fs");
+const path_1 = require("path");
+const remap_validator_1 = require("./utils/remap-validator");
 const addon = (0, bindings_1.default)('keyboard_monitor');
 __exportStar(require("./types/keyboard"), exports);
+const COMPILED_CONFIG_EXTENSION = '.hccfg';
+const MAX_CACHED_CONFIGS = 16;
 class KeyboardMonitor {
     constructor(callback) {
         this.monitor = new addon.KeyboardMonitor(callback);
@@ -34,5 +40,88 @@ class KeyboardMonitor {
     setConfig(config) {
         this.monitor.setConfig(config);
     }
+    /**
+     * Milliseconds the key has been held, or -1 if it is not currently held
+     */
+    getHoldDuration(key) {
+        return this.monitor.getHoldDuration(key);
+    }
+    /**
+     * Per-stage throughput counters, in pipeline order
+     */
+    getPipelineStats() {
+        return this.monitor.getPipelineStats();
+    }
+    /**
+     * Writes recorded spans as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+     * Requires `tracing: true` in the config; returns false if the file can't be written.
+     */
+    writeTrace(path) {
+        return this.monitor.writeTrace(path);
+    }
+    /**
+     * Writes the monitor's current effective config as a compiled binary image
+     */
+    saveCompiledConfig(path, hash) {
+        return this.monitor.saveCompiledConfig(path, hash);
+    }
+    /**
+     * Maps a compiled image and applies it; false if it is missing, stale or damaged
+     */
+    loadCompiledConfig(path, hash) {
+        return this.monitor.loadCompiledConfig(path, hash);
+    }
+    /**
+     * Applies a complete config through an on-disk cache of compiled images.
+     * A hit maps the image compiled last time and skips parsing and validation;
+     * a miss validates remaps, replaces the whole config and caches the result.
+     * Fields the config leaves out go back to their defaults either way, so a
+     * hit and a miss end in the same state. Configs with remap errors are
+     * still applied but never cached.
+     */
+    applyConfig(config, cacheDir) {
+        const hash = (0, crypto_1.createHash)('sha256').update(JSON.stringify(config)).digest('hex');
+        const imagePath = (0, path_1.join)(cacheDir, `${hash}${COMPILED_CONFIG_EXTENSION}`);
+        if ((0, fs_1.existsSync)(imagePath) && this.monitor.loadCompiledConfig(imagePath, hash)) {
+            touchCompiledConfig(imagePath);
+            return { fromCache: true, errors: [] };
+        }
+        const errors = (0, remap_validator_1.validateRemapRules)(config.remaps);
+        this.monitor.setConfig(config, true);
+        if (errors.length === 0) {
+            try {
+                (0, fs_1.mkdirSync)(cacheDir, { recursive: true });
+                if (this.monitor.saveCompiledConfig(imagePath, hash)) {
+                    pruneCompiledConfigs(cacheDir);
+                }
+            }
+            catch {
+                // The cache is best-effort; the config is already applied
+            }
+        }
+        return { fromCache: false, errors };
+    }
 }
 exports.KeyboardMonitor = KeyboardMonitor;
+function touchCompiledConfig(imagePath) {
+    try {
+        const now = new Date();
+        (0, fs_1.utimesSync)(imagePath, now, now);
+    }
+    catch {
+        // Only affects pruning order
+    }
+}
+/**
+ * Keeps the most recently used images, one per distinct config
+ */
+function pruneCompiledConfigs(cacheDir) {
+    const images = (0, fs_1.readdirSync)(cacheDir)
+        .filter((name) => name.endsWith(COMPILED_CONFIG_EXTENSION))
+        .map((name) => (0, path_1.join)(cacheDir, name))
+        .map((path) => ({ path, mtimeMs: (0, fs_1.statSync)(path).mtimeMs }))
+        .sort((a, b) => b.mtimeMs - a.mtimeMs);
+    for (const image of images.slice(MAX_CACHED_CONFIGS)) {
+        (0, fs_1.unlinkSync)(image.path);
+    }
+}
@@ -25,7 +25,79 @@ export interface KeyboardFrame {
   state: KeyState;
   gateOpen: boolean;
 }
+/**
+ * Emitted once per registered threshold when a key has been held that long
+ */
+export interface HoldEvent {
+  key: string;
+  thresholdMs: number;
+  heldMs: number;
+}
+/**
+ * Emitted when a key press completes a registered chord
+ */
+export interface ChordEvent {
+  id: number;
+  key: string;
+}
+/**
+ * Speculative move recognition: 'start' fires on the completing transition,
+ * then exactly one of 'confirm' or 'cancel' once the speculation window closes
+ */
+export type MovePhase = 'start' | 'confirm' | 'cancel';
+export interface MoveEvent {
+  name: string;
+  phase: MovePhase;
+  timestamp: number;
+}
+/**
+ * Payloads for each event the native module emits
+ */
+export interface KeyboardEventMap {
+  frame: KeyboardFrame;
+  hold: HoldEvent;
+  chord: ChordEvent;
+  move: MoveEvent;
+}
+export type KeyboardEventArgs = {
+  [K in keyof KeyboardEventMap]: [eventName: K, data: KeyboardEventMap[K]];
+}[keyof KeyboardEventMap];
 export type CapsLockBehavior = 'None' | 'DoublePress' | 'BlockToggle';
+/**
+ * Thread a pipeline stage runs on. Capture, chords, moves and filter always
+ * run on the capture thread; the frame builder and sinks can be
+ * offloaded to a worker.
+ */
+export type StagePlacement = 'capture' | 'worker';
+export interface PipelineConfig {
+  frameBuilder?: StagePlacement;
+  sinks?: StagePlacement;
+}
+export interface PipelineStageStats {
+  stage: string;
+  placement: StagePlacement;
+  processed: number;
+  dropped: number;
+}
+export interface ChordBindingConfig {
+  id: number;
+  keys: string[];
+  trigger?: string;
+  forbidden?: string[];
+}
+export interface MoveStepConfig {
+  type: 'press' | 'hold';
+  keys: string[];
+  minHoldMs?: number;
+  maxHoldMs?: number;
+  maxGapMs?: number;
+  multiPressToleranceMs?: number;
+  completeOnReleaseAfterMinHold?: boolean;
+}
+export interface MoveConfig {
+  name: string;
+  steps: MoveStepConfig[];
+}
 export interface RemapRule {
   from: string;
   to: string[];
@@ -35,6 +107,13 @@ export interface RemapValidationError {
   message: string;
   rule?: RemapRule;
 }
+/**
+ * Outcome of KeyboardMonitor.applyConfig
+ */
+export interface ConfigApplyResult {
+  fromCache: boolean;
+  errors: RemapValidationError[];
+}
 /**
  * Configuration for the keyboard monitor
  */
@@ -48,4 +127,10 @@ export interface KeyboardConfig {
   frameBufferSize: number;
   bufferWindow?: number;
   gateTimeout: number;
+  holdThresholds?: Record<string, number | number[]>;
+  chords?: ChordBindingConfig[];
+  moves?: MoveConfig[];
+  moveSpeculationWindowMs?: number;
+  pipeline?: PipelineConfig;
+  tracing?: boolean;
 }
@@ -0,0 +1,89 @@
+#include "chord_matcher.h"
+#include <algorithm>
+
+namespace {
+    bool ChordLess(const ChordBinding& a, const ChordBinding& b) {
+        if (a.triggerVk != b.triggerVk) return a.triggerVk < b.triggerVk;
+        for (int i = 0; i < KeySnapshot::WORD_COUNT; i++) {
+            if (a.required.words[i] != b.required.words[i]) {
+                return a.required.words[i] < b.required.words[i];
+            }
+        }
+        return false;
+    }
+}
+
+ChordMatcher::ChordMatcher() {
+    Clear();
+}
+
+void ChordMatcher::Build(std::vector<ChordBinding> chords) {
+    Clear();
+
+    // Drop bindings whose trigger is out of range, and make sure the trigger is required
+    chords.erase(std::remove_if(chords.begin(), chords.end(), [](const ChordBinding& chord) {
+        return chord.triggerVk == 0 || chord.triggerVk >= KEY_COUNT;
+    }), chords.end());
+    for (auto& chord : chords) {
+        chord.required.Set(chord.triggerVk);
+    }
+
+    std::stable_sort(chords.begin(), chords.end(), ChordLess);
+    bindings = std::move(chords);
+
+    // Size the index to at most 50% load
+    size_t slotCount = 16;
+    while (slotCount < bindings.size() * 2) slotCount <<= 1;
+    slots.assign(slotCount, Slot());
+    slotMask = slotCount - 1;
+
+    uint32_t i = 0;
+    while (i < bindings.size()) {
+        const ChordBinding& first = bindings[i];
+        uint32_t end = i + 1;
+        while (end < bindings.size() && !ChordLess(first, bindings[end])) end++;
+
+        uint64_t index = Hash(first.triggerVk, first.required) & slotMask;
+        while (slots[index].begin != slots[index].end) index = (index + 1) & slotMask;
+        slots[index] = Slot{first.required, first.triggerVk, i, end};
+
+        Range& range = triggerRanges[first.triggerVk];
+        if (range.begin == range.end) range.begin = i;
+        range.end = end;
+
+        KeySnapshot others = first.required;
+        others.Reset(first.triggerVk);
+        triggerKeys[first.triggerVk] |= others;
+
+        i = end;
+    }
+}
+
+void ChordMatcher::Clear() {
+    bindings.clear();
+    slots.assign(16, Slot());
+    slotMask = 15;
+    triggerRanges.fill(Range());
+    triggerKeys.fill(KeySnapshot());
+}
+
+uint64_t ChordMatcher::Hash(uint32_t triggerVk, const KeySnapshot& required) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL * (triggerVk + 1);
+    for (int i = 0; i < KeySnapshot::WORD_COUNT; i++) {
+        hash ^= required.words[i] + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+const ChordMatcher::Slot* ChordMatcher::Find(uint32_t triggerVk, const KeySnapshot& required) const {
+    uint64_t index = Hash(triggerVk, required) & slotMask;
+    while (slots[index].begin != slots[index].end) {
+        const Slot& slot = slots[index];
+        if (slot.triggerVk == triggerVk && slot.required == required) return &slot;
+        index = (index + 1) & slotMask;
+    }
+    return nullptr;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "key_snapshot.h"
+
+// A hotkey binding: fires when triggerVk is pressed while every key in
+// required is held and no key in forbidden is held.
+struct ChordBinding {
+    uint32_t id;
+    uint32_t triggerVk;
+    KeySnapshot required;   // includes triggerVk
+    KeySnapshot forbidden;
+};
+
+// Registry of chord bindings indexed by trigger key and exact required mask.
+//
+// On a press, only keys that appear in some binding for that trigger are
+// considered. The matcher then either looks up every subset of those held
+// keys in the hash index, or scans the trigger's bucket, whichever touches
+// fewer entries. With the handful of keys a hand can hold, cost stays flat
+// no matter how many bindings are registered.
+class ChordMatcher {
+public:
+    static const int KEY_COUNT = KeySnapshot::KEY_COUNT;
+
+    ChordMatcher();
+
+    void Build(std::vector<ChordBinding> chords);
+    void Clear();
+    size_t Size() const { return bindings.size(); }
+
+    // Calls onMatch(id) for each binding satisfied by pressing triggerVk with
+    // held already containing it. Returns the number of matches.
+    template <typename Callback>
+    int Match(uint32_t triggerVk, const KeySnapshot& held, Callback&& onMatch) const {
+        if (triggerVk >= KEY_COUNT) return 0;
+        uint32_t bucketBegin = triggerRanges[triggerVk].begin;
+        uint32_t bucketEnd = triggerRanges[triggerVk].end;
+        if (bucketBegin == bucketEnd) return 0;
+
+        KeySnapshot candidates = held;
+        candidates &= triggerKeys[triggerVk];
+
+        uint32_t keys[KEY_COUNT];
+        int keyCount = 0;
+        ForEachKey(candidates, [&keys, &keyCount](uint32_t vk) { keys[keyCount++] = vk; });
+
+        int matches = 0;
+        auto emit = [&](const ChordBinding& binding) {
+            if (!binding.forbidden.Intersects(held)) {
+                onMatch(binding.id);
+                matches++;
+            }
+        };
+
+        uint32_t bucketSize = bucketEnd - bucketBegin;
+        if (keyCount >= MAX_SUBSET_KEYS || (1u << keyCount) > bucketSize) {
+            for (uint32_t i = bucketBegin; i < bucketEnd; i++) {
+                if (bindings[i].required.IsSubsetOf(held)) emit(bindings[i]);
+            }
+            return matches;
+        }
+
+        // Walk subsets in Gray-code order so each step toggles a single key
+        KeySnapshot required;
+        required.Set(triggerVk);
+        uint32_t subsetCount = 1u << keyCount;
+        for (uint32_t i = 0; i < subsetCount; i++) {
+            if (i > 0) required.Toggle(keys[CountTrailingZeros64(i)]);
+
+            const Slot* slot = Find(triggerVk, required);
+            if (!slot) continue;
+            for (uint32_t j = slot->begin; j < slot->end; j++) emit(bindings[j]);
+        }
+        return matches;
+    }
+
+private:
+    static const int MAX_SUBSET_KEYS = 16;
+
+    struct Range {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    // Open-addressed index of (trigger, required) -> range in bindings
+    struct Slot {
+        KeySnapshot required;
+        uint32_t triggerVk = 0;
+        uint32_t begin = 0;
+        uint32_t end = 0;  // begin == end marks an empty slot
+    };
+
+    // Sorted by (triggerVk, required) so equal keys form contiguous ranges
+    std::vector<ChordBinding> bindings;
+    std::vector<Slot> slots;
+    uint64_t slotMask = 0;
+    std::array<Range, KEY_COUNT> triggerRanges;
+    // Union of the non-trigger required keys across each trigger's bindings
+    std::array<KeySnapshot, KEY_COUNT> triggerKeys;
+
+    static uint64_t Hash(uint32_t triggerVk, const KeySnapshot& required);
+    const Slot* Find(uint32_t triggerVk, const KeySnapshot& required) const;
+};
@@ -0,0 +1,262 @@
+#include "compiled_config.h"
+#include "key_names.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    class ImageWriter {
+    public:
+        explicit ImageWriter(std::vector<uint8_t>& out) : out(out) {}
+
+        template <typename T>
+        void Put(const T& value) {
+            PutBytes(&value, sizeof(T));
+        }
+
+        void PutBytes(const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            out.insert(out.end(), bytes, bytes + size);
+        }
+
+        void PutSnapshot(const KeySnapshot& keys) {
+            PutBytes(keys.words, sizeof(keys.words));
+        }
+
+        void PutString(const std::string& value) {
+            Put(static_cast<uint32_t>(value.size()));
+            PutBytes(value.data(), value.size());
+        }
+
+        void PutVkLists(const VkListTable& lists) {
+            Put(static_cast<uint32_t>(lists.size()));
+            for (const auto& [vkCode, values] : lists) {
+                Put(vkCode);
+                Put(static_cast<uint32_t>(values.size()));
+                if (!values.empty()) PutBytes(values.data(), values.size() * sizeof(uint32_t));
+            }
+        }
+
+    private:
+        std::vector<uint8_t>& out;
+    };
+
+    // Bounds-checked cursor; any overrun marks the whole read failed
+    class ImageReader {
+    public:
+        ImageReader(const uint8_t* data, size_t size) : cursor(data), end(data + size) {}
+
+        template <typename T>
+        bool Get(T& value) {
+            return GetBytes(&value, sizeof(T));
+        }
+
+        bool GetBytes(void* data, size_t size) {
+            if (static_cast<size_t>(end - cursor) < size) return false;
+            std::memcpy(data, cursor, size);
+            cursor += size;
+            return true;
+        }
+
+        bool GetSnapshot(KeySnapshot& keys) {
+            return GetBytes(keys.words, sizeof(keys.words));
+        }
+
+        bool GetString(std::string& value) {
+            uint32_t length = 0;
+            if (!GetCount(length, 1)) return false;
+            value.resize(length);
+            return !length || GetBytes(&value[0], length);
+        }
+
+        // Rejects counts that could not fit in what's left, before allocating
+        bool GetCount(uint32_t& count, size_t minRecordSize) {
+            return Get(count) && count <= static_cast<size_t>(end - cursor) / minRecordSize;
+        }
+
+        bool GetVkLists(VkListTable& lists) {
+            uint32_t count = 0;
+            if (!GetCount(count, sizeof(uint32_t) * 2)) return false;
+            lists.resize(count);
+            for (auto& [vkCode, values] : lists) {
+                uint32_t valueCount = 0;
+                if (!Get(vkCode) || vkCode >= KeySnapshot::KEY_COUNT) return false;
+                if (!GetCount(valueCount, sizeof(uint32_t))) return false;
+                values.resize(valueCount);
+                if (valueCount && !GetBytes(values.data(), valueCount * sizeof(uint32_t))) return false;
+            }
+            return true;
+        }
+
+        bool AtEnd() const { return cursor == end; }
+
+    private:
+        const uint8_t* cursor;
+        const uint8_t* end;
+    };
+
+    static_assert(sizeof(CompiledConfigImage::Header) == 96, "image header layout changed; bump VERSION");
+
+    const size_t STEP_RECORD_SIZE = 2 + sizeof(KeySnapshot) + 4 * sizeof(int32_t);
+}
+
+void CompiledConfigImage::Write(const CompiledConfig& config, const std::string& configHash, std::vector<uint8_t>& image) {
+    image.assign(sizeof(Header), 0);
+    ImageWriter writer(image);
+
+    writer.Put(static_cast<int32_t>(config.frameTimeMicros));
+    writer.Put(static_cast<int32_t>(config.gateTimeout));
+    writer.Put(static_cast<int32_t>(config.moveSpeculationWindowMs));
+    writer.Put(static_cast<uint8_t>(config.isRemapperEnabled));
+    writer.Put(static_cast<uint8_t>(config.isTracingEnabled));
+    writer.Put(static_cast<uint8_t>(config.frameBuilderPlacement));
+    writer.Put(static_cast<uint8_t>(config.sinkPlacement));
+    writer.Put(static_cast<int32_t>(config.maxRemapChainLength));
+
+    writer.Put(static_cast<uint32_t>(config.remapNames.size()));
+    for (const auto& [keyName, targetNames] : config.remapNames) {
+        writer.PutString(keyName);
+        writer.Put(static_cast<uint32_t>(targetNames.size()));
+        for (const std::string& targetName : targetNames) writer.PutString(targetName);
+    }
+
+    writer.PutVkLists(config.remaps);
+    writer.PutVkLists(config.holdThresholds);
+
+    writer.Put(static_cast<uint32_t>(config.chords.size()));
+    for (const ChordBinding& chord : config.chords) {
+        writer.Put(chord.id);
+        writer.Put(chord.triggerVk);
+        writer.PutSnapshot(chord.required);
+        writer.PutSnapshot(chord.forbidden);
+    }
+
+    writer.Put(static_cast<uint32_t>(config.moves.size()));
+    for (const MoveSpec& move : config.moves) {
+        writer.Put(static_cast<uint32_t>(move.name.size()));
+        writer.PutBytes(move.name.data(), move.name.size());
+        writer.Put(static_cast<uint32_t>(move.steps.size()));
+        for (const MoveStepSpec& step : move.steps) {
+            writer.Put(static_cast<uint8_t>(step.type));
+            writer.Put(static_cast<uint8_t>(step.completeOnReleaseAfterMinHold));
+            writer.PutSnapshot(step.keys);
+            writer.Put(static_cast<int32_t>(step.minHoldMs));
+            writer.Put(static_cast<int32_t>(step.maxHoldMs));
+            writer.Put(static_cast<int32_t>(step.maxGapMs));
+            writer.Put(static_cast<int32_t>(step.multiPressToleranceMs));
+        }
+    }
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.payloadSize = image.size() - sizeof(Header);
+    header.checksum = Checksum(image.data() + sizeof(Header), header.payloadSize);
+    header.keyTableHash = KeyNames::Hash();
+    std::memcpy(header.configHash, configHash.data(), std::min(configHash.size(), HASH_SIZE));
+    std::memcpy(image.data(), &header, sizeof(Header));
+}
+
+bool CompiledConfigImage::Read(const uint8_t* data, size_t size, const std::string& configHash, CompiledConfig& config) {
+    if (!data || size < sizeof(Header)) return false;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (header.magic != MAGIC || header.version != VERSION) return false;
+    if (header.payloadSize != size - sizeof(Header)) return false;
+    if (header.keyTableHash != KeyNames::Hash()) return false;
+
+    char expectedHash[HASH_SIZE] = {};
+    std::memcpy(expectedHash, configHash.data(), std::min(configHash.size(), HASH_SIZE));
+    if (std::memcmp(header.configHash, expectedHash, HASH_SIZE) != 0) return false;
+
+    const uint8_t* payload = data + sizeof(Header);
+    if (Checksum(payload, header.payloadSize) != header.checksum) return false;
+
+    ImageReader reader(payload, header.payloadSize);
+    CompiledConfig decoded;
+
+    int32_t frameTimeMicros = 0, gateTimeout = 0, moveSpeculationWindowMs = 0, maxRemapChainLength = 0;
+    uint8_t isRemapperEnabled = 0, isTracingEnabled = 0, frameBuilderPlacement = 0, sinkPlacement = 0;
+    if (!reader.Get(frameTimeMicros) || !reader.Get(gateTimeout) || !reader.Get(moveSpeculationWindowMs) ||
+        !reader.Get(isRemapperEnabled) || !reader.Get(isTracingEnabled) ||
+        !reader.Get(frameBuilderPlacement) || !reader.Get(sinkPlacement) || !reader.Get(maxRemapChainLength)) {
+        return false;
+    }
+    decoded.frameTimeMicros = frameTimeMicros;
+    decoded.gateTimeout = gateTimeout;
+    decoded.moveSpeculationWindowMs = moveSpeculationWindowMs;
+    decoded.isRemapperEnabled = isRemapperEnabled != 0;
+    decoded.isTracingEnabled = isTracingEnabled != 0;
+    decoded.frameBuilderPlacement = frameBuilderPlacement ? StagePlacement::Worker : StagePlacement::Capture;
+    decoded.sinkPlacement = sinkPlacement ? StagePlacement::Worker : StagePlacement::Capture;
+    decoded.maxRemapChainLength = maxRemapChainLength;
+
+    uint32_t remapNameCount = 0;
+    if (!reader.GetCount(remapNameCount, sizeof(uint32_t) * 2)) return false;
+    for (uint32_t i = 0; i < remapNameCount; i++) {
+        std::string keyName;
+        uint32_t targetCount = 0;
+        if (!reader.GetString(keyName) || !reader.GetCount(targetCount, sizeof(uint32_t))) return false;
+
+        std::vector<std::string>& targetNames = decoded.remapNames[keyName];
+        targetNames.resize(targetCount);
+        for (std::string& targetName : targetNames) {
+            if (!reader.GetString(targetName)) return false;
+        }
+    }
+
+    if (!reader.GetVkLists(decoded.remaps) || !reader.GetVkLists(decoded.holdThresholds)) return false;
+
+    uint32_t chordCount = 0;
+    if (!reader.GetCount(chordCount, sizeof(uint32_t) * 2 + sizeof(KeySnapshot) * 2)) return false;
+    decoded.chords.resize(chordCount);
+    for (ChordBinding& chord : decoded.chords) {
+        if (!reader.Get(chord.id) || !reader.Get(chord.triggerVk) ||
+            !reader.GetSnapshot(chord.required) || !reader.GetSnapshot(chord.forbidden)) {
+            return false;
+        }
+    }
+
+    uint32_t moveCount = 0;
+    if (!reader.GetCount(moveCount, sizeof(uint32_t) * 2)) return false;
+    decoded.moves.resize(moveCount);
+    for (MoveSpec& move : decoded.moves) {
+        uint32_t nameLength = 0;
+        if (!reader.GetCount(nameLength, 1)) return false;
+        move.name.resize(nameLength);
+        if (nameLength && !reader.GetBytes(&move.name[0], nameLength)) return false;
+
+        uint32_t stepCount = 0;
+        if (!reader.GetCount(stepCount, STEP_RECORD_SIZE)) return false;
+        move.steps.resize(stepCount);
+        for (MoveStepSpec& step : move.steps) {
+            uint8_t type = 0, completeOnRelease = 0;
+            int32_t minHoldMs = 0, maxHoldMs = 0, maxGapMs = 0, multiPressToleranceMs = 0;
+            if (!reader.Get(type) || !reader.Get(completeOnRelease) || !reader.GetSnapshot(step.keys) ||
+                !reader.Get(minHoldMs) || !reader.Get(maxHoldMs) ||
+                !reader.Get(maxGapMs) || !reader.Get(multiPressToleranceMs)) {
+                return false;
+            }
+            step.type = type ? MoveStepType::Hold : MoveStepType::Press;
+            step.completeOnReleaseAfterMinHold = completeOnRelease != 0;
+            step.minHoldMs = minHoldMs;
+            step.maxHoldMs = maxHoldMs;
+            step.maxGapMs = maxGapMs;
+            step.multiPressToleranceMs = multiPressToleranceMs;
+        }
+    }
+
+    if (!reader.AtEnd()) return false;
+
+    config = std::move(decoded);
+    return true;
+}
+
+uint64_t CompiledConfigImage::Checksum(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
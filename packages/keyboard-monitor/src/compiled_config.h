@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "chord_matcher.h"
+#include "input_pipeline.h"
+#include "move_recognizer.h"
+
+// Per-VK lists: (vkCode, values)
+using VkListTable = std::vector<std::pair<uint32_t, std::vector<uint32_t>>>;
+
+// Everything SetConfig resolves from a JS config object. Key names are already
+// VK codes and remaps have already passed the circular-chain check, so
+// applying one only builds runtime tables.
+struct CompiledConfig {
+    // Remaps as named in the config, kept so a later partial setConfig (say,
+    // only maxRemapChainLength) recompiles from the same source
+    std::map<std::string, std::vector<std::string>> remapNames;
+    int maxRemapChainLength = 5;
+    VkListTable remaps;
+    VkListTable holdThresholds;
+    std::vector<ChordBinding> chords;
+    std::vector<MoveSpec> moves;
+
+    int frameTimeMicros = 16667;
+    int gateTimeout = 1000;
+    int moveSpeculationWindowMs = -1;  // -1 follows the frame period
+    bool isRemapperEnabled = false;
+    bool isTracingEnabled = false;
+    StagePlacement frameBuilderPlacement = StagePlacement::Capture;
+    StagePlacement sinkPlacement = StagePlacement::Capture;
+};
+
+// Versioned, checksummed binary form of a CompiledConfig, cached on disk so
+// the next start skips N-API parsing, key-name lookup and remap validation.
+// This is cached compile output, not a zero-copy table: Read decodes the
+// mapped file into CompiledConfig's heap containers, and the caller then
+// builds the runtime tables with ApplyConfig as for a fresh config.
+//
+// Layout: a fixed header followed by the payload. The header carries the
+// caller's config hash and the key-name table hash, so an image is only
+// accepted for the exact config and key-name table it was compiled with. A
+// build that renumbers or renames keys invalidates old images on its own. Any
+// layout change must bump VERSION.
+class CompiledConfigImage {
+public:
+    static constexpr uint32_t MAGIC = 0x46434348;  // "HCCF"
+    static constexpr uint32_t VERSION = 4;
+    static constexpr size_t HASH_SIZE = 64;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t payloadSize;
+        uint64_t checksum;      // FNV-1a over the payload
+        uint64_t keyTableHash;  // KeyNames::Hash() of the writing build
+        char configHash[HASH_SIZE];
+    };
+
+    static void Write(const CompiledConfig& config, const std::string& configHash, std::vector<uint8_t>& image);
+
+    // Checks magic, version, both hashes and the checksum before decoding
+    // anything. Reads unaligned, so data can point straight into a mapped view.
+    static bool Read(const uint8_t* data, size_t size, const std::string& configHash, CompiledConfig& config);
+
+    static uint64_t Checksum(const uint8_t* data, size_t size);
+};
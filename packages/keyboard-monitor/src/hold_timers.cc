@@ -0,0 +1,124 @@
+#include "hold_timers.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // std::*_heap builds a max-heap; invert the comparison for earliest-first
+    template <typename T>
+    bool DeadlineLater(const T& a, const T& b) {
+        return a.deadlineMs > b.deadlineMs;
+    }
+}
+
+HoldTimerQueue::HoldTimerQueue() {
+    nextThreshold.fill(0);
+    for (auto& pressTime : pressTimes) {
+        pressTime.store(-1, std::memory_order_relaxed);
+    }
+    heap.reserve(KEY_COUNT);
+}
+
+void HoldTimerQueue::SetThresholds(uint32_t vkCode, std::vector<uint32_t> thresholdsMs, long long nowMs) {
+    if (vkCode >= KEY_COUNT) return;
+
+    std::sort(thresholdsMs.begin(), thresholdsMs.end());
+    thresholdsMs.erase(std::unique(thresholdsMs.begin(), thresholdsMs.end()), thresholdsMs.end());
+    thresholds[vkCode] = std::move(thresholdsMs);
+
+    // Reschedule if the key is currently held so the new thresholds apply.
+    // Thresholds the hold has already crossed have fired (or would have), so
+    // resume from the first one still ahead instead of replaying them.
+    RemoveDeadline(vkCode);
+    long long pressTime = pressTimes[vkCode].load(std::memory_order_relaxed);
+    if (pressTime >= 0) {
+        const auto& keyThresholds = thresholds[vkCode];
+        long long heldMs = nowMs - pressTime;
+        auto next = std::find_if(keyThresholds.begin(), keyThresholds.end(), [heldMs](uint32_t thresholdMs) {
+            return thresholdMs > heldMs;
+        });
+        nextThreshold[vkCode] = static_cast<uint32_t>(next - keyThresholds.begin());
+        ScheduleNext(vkCode, pressTime);
+    }
+}
+
+void HoldTimerQueue::ClearThresholds() {
+    for (auto& keyThresholds : thresholds) {
+        keyThresholds.clear();
+    }
+    nextThreshold.fill(0);
+    heap.clear();
+}
+
+bool HoldTimerQueue::HasThresholds(uint32_t vkCode) const {
+    return vkCode < KEY_COUNT && !thresholds[vkCode].empty();
+}
+
+void HoldTimerQueue::OnKeyPressed(uint32_t vkCode, long long nowMs) {
+    if (vkCode >= KEY_COUNT) return;
+
+    // Ignore auto-repeat: the original press time stays authoritative
+    if (pressTimes[vkCode].load(std::memory_order_relaxed) >= 0) return;
+
+    pressTimes[vkCode].store(nowMs, std::memory_order_relaxed);
+    nextThreshold[vkCode] = 0;
+    ScheduleNext(vkCode, nowMs);
+}
+
+void HoldTimerQueue::OnKeyReleased(uint32_t vkCode) {
+    if (vkCode >= KEY_COUNT) return;
+    if (pressTimes[vkCode].load(std::memory_order_relaxed) < 0) return;
+
+    pressTimes[vkCode].store(-1, std::memory_order_relaxed);
+    RemoveDeadline(vkCode);
+}
+
+void HoldTimerQueue::Reset() {
+    for (auto& pressTime : pressTimes) {
+        pressTime.store(-1, std::memory_order_relaxed);
+    }
+    nextThreshold.fill(0);
+    heap.clear();
+}
+
+long long HoldTimerQueue::GetHoldDuration(uint32_t vkCode, long long nowMs) const {
+    long long pressTime = GetPressTime(vkCode);
+    return pressTime >= 0 ? nowMs - pressTime : -1;
+}
+
+long long HoldTimerQueue::GetPressTime(uint32_t vkCode) const {
+    if (vkCode >= KEY_COUNT) return -1;
+    return pressTimes[vkCode].load(std::memory_order_relaxed);
+}
+
+long long HoldTimerQueue::NextDeadline() const {
+    return heap.empty() ? std::numeric_limits<long long>::max() : heap.front().deadlineMs;
+}
+
+void HoldTimerQueue::ScheduleNext(uint32_t vkCode, long long pressTime) {
+    const auto& keyThresholds = thresholds[vkCode];
+    uint32_t index = nextThreshold[vkCode];
+    if (index >= keyThresholds.size()) return;
+
+    nextThreshold[vkCode] = index + 1;
+    heap.push_back(Deadline{pressTime + keyThresholds[index], vkCode, keyThresholds[index]});
+    std::push_heap(heap.begin(), heap.end(), DeadlineLater<Deadline>);
+}
+
+HoldTimerQueue::Deadline HoldTimerQueue::PopDeadline() {
+    std::pop_heap(heap.begin(), heap.end(), DeadlineLater<Deadline>);
+    Deadline due = heap.back();
+    heap.pop_back();
+    return due;
+}
+
+void HoldTimerQueue::RemoveDeadline(uint32_t vkCode) {
+    // At most one pending entry per key, and at most one entry per held key overall
+    auto it = std::find_if(heap.begin(), heap.end(), [vkCode](const Deadline& d) {
+        return d.vkCode == vkCode;
+    });
+    if (it == heap.end()) return;
+
+    *it = heap.back();
+    heap.pop_back();
+    std::make_heap(heap.begin(), heap.end(), DeadlineLater<Deadline>);
+}
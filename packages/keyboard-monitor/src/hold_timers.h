@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A hold threshold that has just been crossed by a held key.
+struct HoldReached {
+    uint32_t vkCode;
+    uint32_t thresholdMs;
+    long long heldMs;
+};
+
+// Tracks press timestamps for every virtual key and fires "hold reached" events
+// for registered per-key thresholds exactly when their deadlines expire.
+//
+// Each held key has at most one pending deadline in the min-heap: the next
+// threshold it has not reached yet. When that deadline fires, the following
+// threshold for the same key is scheduled. Checking for expired deadlines is a
+// single comparison against the heap top, so per-poll cost does not depend on
+// how many keys are held.
+class HoldTimerQueue {
+public:
+    static const int KEY_COUNT = 256;
+
+    HoldTimerQueue();
+
+    // Threshold registration (config time). For a key already held at nowMs,
+    // only thresholds it has not crossed yet are scheduled.
+    void SetThresholds(uint32_t vkCode, std::vector<uint32_t> thresholdsMs, long long nowMs);
+    void ClearThresholds();
+    bool HasThresholds(uint32_t vkCode) const;
+
+    // Key transitions (capture thread)
+    void OnKeyPressed(uint32_t vkCode, long long nowMs);
+    void OnKeyReleased(uint32_t vkCode);
+    void Reset();
+
+    // Hold duration is derived from the press timestamp on demand. Safe to
+    // call from any thread; returns -1 if the key is not held.
+    long long GetHoldDuration(uint32_t vkCode, long long nowMs) const;
+    long long GetPressTime(uint32_t vkCode) const;
+
+    // Fires onReached for every deadline that expired at or before nowMs.
+    template <typename Callback>
+    void Expire(long long nowMs, Callback&& onReached) {
+        while (!heap.empty() && heap.front().deadlineMs <= nowMs) {
+            Deadline due = PopDeadline();
+            long long pressTime = pressTimes[due.vkCode].load(std::memory_order_relaxed);
+            onReached(HoldReached{due.vkCode, due.thresholdMs, nowMs - pressTime});
+            ScheduleNext(due.vkCode, pressTime);
+        }
+    }
+
+    long long NextDeadline() const;
+    size_t PendingCount() const { return heap.size(); }
+
+private:
+    struct Deadline {
+        long long deadlineMs;
+        uint32_t vkCode;
+        uint32_t thresholdMs;
+    };
+
+    // Sorted ascending per key
+    std::array<std::vector<uint32_t>, KEY_COUNT> thresholds;
+    // Index into thresholds[vk] of the next deadline to schedule
+    std::array<uint32_t, KEY_COUNT> nextThreshold;
+    // Press time in ms, or -1 when the key is up
+    std::array<std::atomic<long long>, KEY_COUNT> pressTimes;
+    // Min-heap ordered by deadlineMs; holds at most one entry per held key
+    std::vector<Deadline> heap;
+
+    void ScheduleNext(uint32_t vkCode, long long pressTime);
+    Deadline PopDeadline();
+    void RemoveDeadline(uint32_t vkCode);
+};
@@ -1,19 +1,33 @@
 import bindings from 'bindings';
-import type { KeyboardConfig, KeyboardFrame } from './types/keyboard';
+import { createHash } from 'crypto';
+import { existsSync, mkdirSync, readdirSync, statSync, unlinkSync, utimesSync } from 'fs';
+import { join } from 'path';
+import type {
+  ConfigApplyResult,
+  KeyboardConfig,
+  KeyboardEventArgs,
+  PipelineStageStats,
+} from './types/keyboard';
+import { validateRemapRules } from './utils/remap-validator';
 
 const addon = bindings('keyboard_monitor');
 
 export * from './types/keyboard';
 
-export type KeyboardEventCallback = (
-  eventName: string,
-  data: KeyboardFrame
-) => void;
+export type KeyboardEventCallback = (...args: KeyboardEventArgs) => void;
+
+const COMPILED_CONFIG_EXTENSION = '.hccfg';
+const MAX_CACHED_CONFIGS = 16;
 
 interface NativeKeyboardMonitor {
   start(): void;
   stop(): void;
-  setConfig(config: KeyboardConfig): void;
+  setConfig(config: KeyboardConfig, replace?: boolean): void;
+  getHoldDuration(key: string): number;
+  getPipelineStats(): PipelineStageStats[];
+  writeTrace(path: string): boolean;
+  saveCompiledConfig(path: string, hash: string): boolean;
+  loadCompiledConfig(path: string, hash: string): boolean;
 }
 
 export class KeyboardMonitor {
@@ -34,4 +48,98 @@ export class KeyboardMonitor {
   setConfig(config: KeyboardConfig): void {
     this.monitor.setConfig(config);
   }
+
+  /**
+   * Milliseconds the key has been held, or -1 if it is not currently held
+   */
+  getHoldDuration(key: string): number {
+    return this.monitor.getHoldDuration(key);
+  }
+
+  /**
+   * Per-stage throughput counters, in pipeline order
+   */
+  getPipelineStats(): PipelineStageStats[] {
+    return this.monitor.getPipelineStats();
+  }
+
+  /**
+   * Writes recorded spans as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+   * Requires `tracing: true` in the config; returns false if the file can't be written.
+   */
+  writeTrace(path: string): boolean {
+    return this.monitor.writeTrace(path);
+  }
+
+  /**
+   * Writes the monitor's current effective config as a compiled binary image
+   */
+  saveCompiledConfig(path: string, hash: string): boolean {
+    return this.monitor.saveCompiledConfig(path, hash);
+  }
+
+  /**
+   * Maps a compiled image and applies it; false if it is missing, stale or damaged
+   */
+  loadCompiledConfig(path: string, hash: string): boolean {
+    return this.monitor.loadCompiledConfig(path, hash);
+  }
+
+  /**
+   * Applies a complete config through an on-disk cache of compiled images.
+   * A hit maps the image compiled last time and skips parsing and validation;
+   * a miss validates remaps, replaces the whole config and caches the result.
+   * Fields the config leaves out go back to their defaults either way, so a
+   * hit and a miss end in the same state. Configs with remap errors are
+   * still applied but never cached.
+   */
+  applyConfig(config: KeyboardConfig, cacheDir: string): ConfigApplyResult {
+    const hash = createHash('sha256').update(JSON.stringify(config)).digest('hex');
+    const imagePath = join(cacheDir, `${hash}${COMPILED_CONFIG_EXTENSION}`);
+
+    if (existsSync(imagePath) && this.monitor.loadCompiledConfig(imagePath, hash)) {
+      touchCompiledConfig(imagePath);
+      return { fromCache: true, errors: [] };
+    }
+
+    const errors = validateRemapRules(config.remaps);
+    this.monitor.setConfig(config, true);
+
+    if (errors.length === 0) {
+      try {
+        mkdirSync(cacheDir, { recursive: true });
+        if (this.monitor.saveCompiledConfig(imagePath, hash)) {
+          pruneCompiledConfigs(cacheDir);
+        }
+      } catch {
+        // The cache is best-effort; the config is already applied
+      }
+    }
+
+    return { fromCache: false, errors };
+  }
+}
+
+function touchCompiledConfig(imagePath: string): void {
+  try {
+    const now = new Date();
+    utimesSync(imagePath, now, now);
+  } catch {
+    // Only affects pruning order
+  }
+}
+
+/**
+ * Keeps the most recently used images, one per distinct config
+ */
+function pruneCompiledConfigs(cacheDir: string): void {
+  const images = readdirSync(cacheDir)
+    .filter((name) => name.endsWith(COMPILED_CONFIG_EXTENSION))
+    .map((name) => join(cacheDir, name))
+    .map((path) => ({ path, mtimeMs: statSync(path).mtimeMs }))
+    .sort((a, b) => b.mtimeMs - a.mtimeMs);
+
+  for (const image of images.slice(MAX_CACHED_CONFIGS)) {
+    unlinkSync(image.path);
+  }
 }
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "key_snapshot.h"
+
+// A single key transition flowing through the pipeline:
+//   source -> chords -> moves -> filter -> frame builder -> sinks
+struct KeyInputEvent {
+    uint32_t vkCode;
+    bool isKeyDown;
+    long long timestampMs;
+};
+
+// Which thread a stage runs on. The source and input stages always run on the
+// capture thread; the frame builder and sinks can be moved to the worker.
+enum class StagePlacement : uint8_t {
+    Capture,
+    Worker
+};
+
+struct StageCounters {
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> dropped{0};
+
+    void Count(bool passed) {
+        processed.fetch_add(1, std::memory_order_relaxed);
+        if (!passed) dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// Event -> event stage. Returning false stops the event from reaching later stages.
+class InputStage {
+public:
+    virtual ~InputStage() = default;
+    virtual const char* Name() const = 0;
+
+    bool Run(KeyInputEvent& event) {
+        bool passed = Process(event);
+        counters.Count(passed);
+        return passed;
+    }
+
+    StageCounters counters;
+
+protected:
+    virtual bool Process(KeyInputEvent& event) = 0;
+};
+
+// Terminal stage that consumes finished frames (JS emit, journal, analytics...)
+template <typename Frame>
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+    virtual const char* Name() const = 0;
+
+    void Run(const Frame& frame) {
+        Consume(frame);
+        counters.Count(true);
+    }
+
+    StageCounters counters;
+
+protected:
+    virtual void Consume(const Frame& frame) = 0;
+};
+
+// Lock-free single-producer/single-consumer ring. Never blocks and never
+// allocates after construction; a full queue rejects the push.
+template <typename T, size_t Capacity>
+class BoundedQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool TryPush(const T& item) {
+        size_t tailIndex = tail.load(std::memory_order_relaxed);
+        if (tailIndex - head.load(std::memory_order_acquire) == Capacity) {
+            counters.Count(false);
+            return false;
+        }
+        slots[tailIndex & (Capacity - 1)] = item;
+        tail.store(tailIndex + 1, std::memory_order_release);
+        counters.Count(true);
+        return true;
+    }
+
+    bool TryPop(T& item) {
+        size_t headIndex = head.load(std::memory_order_relaxed);
+        if (headIndex == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = slots[headIndex & (Capacity - 1)];
+        head.store(headIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    // Pushes accepted (processed) and rejected because the queue was full (dropped)
+    StageCounters counters;
+
+private:
+    std::array<T, Capacity> slots{};
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+// Replays the transitions that take the frame builder's held set to the keys
+// the source has dispatched, releases first, limited to mask. Nothing differs
+// unless a BoundedQueue push was dropped on the way to the builder. Returns
+// whether anything was replayed.
+template <typename Apply>
+inline bool ResyncHeldKeys(
+    const KeySnapshot& builderHeld,
+    const KeySnapshot& dispatchedKeys,
+    const KeySnapshot& mask,
+    Apply&& apply
+) {
+    KeySnapshotDiff diff;
+    if (!DiffKeySnapshots(builderHeld, dispatchedKeys, mask, diff)) return false;
+
+    ForEachKey(diff.released, [&apply](uint32_t vk) { apply(vk, false); });
+    ForEachKey(diff.pressed, [&apply](uint32_t vk) { apply(vk, true); });
+    return true;
+}
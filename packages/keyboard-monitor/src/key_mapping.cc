@@ -1,4 +1,6 @@
 #include "key_mapping.h"
+#include "key_names.h"
+#include "trace_events.h"
 #include <algorithm>
 #include <cctype>
 #include <chrono>
@@ -6,144 +8,26 @@
 // Static member initialization
 std::map<std::string, DWORD> KeyMapping::keyNameToVK;
 std::map<DWORD, std::string> KeyMapping::vkToKeyName;
-std::map<DWORD, std::vector<DWORD>> KeyMapping::activeRemaps;
-std::map<DWORD, KeyState> KeyMapping::keyStates;
-std::set<DWORD> KeyMapping::processedKeys;
-std::queue<DWORD> KeyMapping::releaseOrder;
+RemapTable KeyMapping::remapTable;
+std::mutex KeyMapping::remapMutex;
+KeyStateTable KeyMapping::keyStates;
+KeySnapshot KeyMapping::processedKeys;
 bool KeyMapping::mapsInitialized = false;
-bool KeyMapping::capsLockRemapped = false;
-bool KeyMapping::reportCapsLock = true;
 
 void KeyMapping::InitializeMaps() {
     if (mapsInitialized) return;
 
-    // Basic keys - store all keys in lowercase for case-insensitive lookup
-    keyNameToVK["capslock"] = VK_CAPITAL;
-    keyNameToVK["capital"] = VK_CAPITAL;  // Support both names
-    keyNameToVK["shift"] = VK_SHIFT;
-    keyNameToVK["control"] = VK_CONTROL;
-    keyNameToVK["alt"] = VK_MENU;
-    keyNameToVK["win"] = VK_LWIN;
-    keyNameToVK["tab"] = VK_TAB;
-    keyNameToVK["enter"] = VK_RETURN;
-    keyNameToVK["space"] = VK_SPACE;
-    keyNameToVK["backspace"] = VK_BACK;
-    keyNameToVK["delete"] = VK_DELETE;
-    keyNameToVK["escape"] = VK_ESCAPE;
-
-    // Left/Right modifiers
-    keyNameToVK["lshift"] = VK_LSHIFT;
-    keyNameToVK["rshift"] = VK_RSHIFT;
-    keyNameToVK["lcontrol"] = VK_LCONTROL;
-    keyNameToVK["rcontrol"] = VK_RCONTROL;
-    keyNameToVK["lalt"] = VK_LMENU;
-    keyNameToVK["ralt"] = VK_RMENU;
-    keyNameToVK["lwin"] = VK_LWIN;
-    keyNameToVK["rwin"] = VK_RWIN;
-
-    // Function keys
-    for (int i = 1; i <= 12; i++) {
-        keyNameToVK["f" + std::to_string(i)] = VK_F1 + i - 1;
-    }
-
-    // Number keys
-    for (int i = 0; i <= 9; i++) {
-        keyNameToVK[std::to_string(i)] = '0' + i;
-    }
-
-    // Letter keys - store in lowercase
-    for (char c = 'a'; c <= 'z'; c++) {
-        keyNameToVK[std::string(1, c)] = toupper(c);
-    }
-
-    // Navigation keys
-    keyNameToVK["home"] = VK_HOME;
-    keyNameToVK["end"] = VK_END;
-    keyNameToVK["pageup"] = VK_PRIOR;
-    keyNameToVK["pagedown"] = VK_NEXT;
-    keyNameToVK["insert"] = VK_INSERT;
-    keyNameToVK["left"] = VK_LEFT;
-    keyNameToVK["right"] = VK_RIGHT;
-    keyNameToVK["up"] = VK_UP;
-    keyNameToVK["down"] = VK_DOWN;
-
-    // Additional keys
-    keyNameToVK["numlock"] = VK_NUMLOCK;
-    keyNameToVK["scrolllock"] = VK_SCROLL;
-    keyNameToVK["printscreen"] = VK_SNAPSHOT;
-    keyNameToVK["pause"] = VK_PAUSE;
-    keyNameToVK["semicolon"] = VK_OEM_1;
-    keyNameToVK["equals"] = VK_OEM_PLUS;
-    keyNameToVK["comma"] = VK_OEM_COMMA;
-    keyNameToVK["minus"] = VK_OEM_MINUS;
-    keyNameToVK["period"] = VK_OEM_PERIOD;
-    keyNameToVK["slash"] = VK_OEM_2;
-    keyNameToVK["backtick"] = VK_OEM_3;
-    keyNameToVK["openbracket"] = VK_OEM_4;
-    keyNameToVK["backslash"] = VK_OEM_5;
-    keyNameToVK["closebracket"] = VK_OEM_6;
-    keyNameToVK["quote"] = VK_OEM_7;
-
-    // Create reverse mapping (keep original casing for display)
-    vkToKeyName[VK_CAPITAL] = "CapsLock";
-    vkToKeyName[VK_SHIFT] = "Shift";
-    vkToKeyName[VK_CONTROL] = "Control";
-    vkToKeyName[VK_MENU] = "Alt";
-    vkToKeyName[VK_LWIN] = "Win";
-    vkToKeyName[VK_TAB] = "Tab";
-    vkToKeyName[VK_RETURN] = "Enter";
-    vkToKeyName[VK_SPACE] = "Space";
-    vkToKeyName[VK_BACK] = "Backspace";
-    vkToKeyName[VK_DELETE] = "Delete";
-    vkToKeyName[VK_ESCAPE] = "Escape";
-    vkToKeyName[VK_LSHIFT] = "LShift";
-    vkToKeyName[VK_RSHIFT] = "RShift";
-    vkToKeyName[VK_LCONTROL] = "LControl";
-    vkToKeyName[VK_RCONTROL] = "RControl";
-    vkToKeyName[VK_LMENU] = "LAlt";
-    vkToKeyName[VK_RMENU] = "RAlt";
-    vkToKeyName[VK_HOME] = "Home";
-    vkToKeyName[VK_END] = "End";
-    vkToKeyName[VK_PRIOR] = "PageUp";
-    vkToKeyName[VK_NEXT] = "PageDown";
-    vkToKeyName[VK_INSERT] = "Insert";
-    vkToKeyName[VK_LEFT] = "Left";
-    vkToKeyName[VK_RIGHT] = "Right";
-    vkToKeyName[VK_UP] = "Up";
-    vkToKeyName[VK_DOWN] = "Down";
-
-    // Function keys reverse mapping
-    for (int i = 1; i <= 12; i++) {
-        vkToKeyName[VK_F1 + i - 1] = "F" + std::to_string(i);
-    }
-
-    // Number keys reverse mapping
-    for (int i = 0; i <= 9; i++) {
-        vkToKeyName['0' + i] = std::to_string(i);
-    }
-
-    // Letter keys reverse mapping (uppercase)
-    for (char c = 'A'; c <= 'Z'; c++) {
-        vkToKeyName[c] = std::string(1, c);
+    // Lookups are case-insensitive, so store lowercase; the reverse mapping
+    // keeps the original casing for display
+    for (const KeyNameEntry& entry : KeyNames::All()) {
+        std::string lowerName = entry.name;
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+        keyNameToVK[lowerName] = entry.vkCode;
+        if (entry.isDisplayName) {
+            vkToKeyName[entry.vkCode] = entry.name;
+        }
     }
 
-    // Additional keys reverse mapping
-    vkToKeyName[VK_NUMLOCK] = "NumLock";
-    vkToKeyName[VK_SCROLL] = "ScrollLock";
-    vkToKeyName[VK_SNAPSHOT] = "PrintScreen";
-    vkToKeyName[VK_PAUSE] = "Pause";
-    vkToKeyName[VK_OEM_1] = "Semicolon";
-    vkToKeyName[VK_OEM_PLUS] = "Equals";
-    vkToKeyName[VK_OEM_COMMA] = "Comma";
-    vkToKeyName[VK_OEM_MINUS] = "Minus";
-    vkToKeyName[VK_OEM_PERIOD] = "Period";
-    vkToKeyName[VK_OEM_2] = "Slash";
-    vkToKeyName[VK_OEM_3] = "Backtick";
-    vkToKeyName[VK_OEM_4] = "OpenBracket";
-    vkToKeyName[VK_OEM_5] = "Backslash";
-    vkToKeyName[VK_OEM_6] = "CloseBracket";
-    vkToKeyName[VK_OEM_7] = "Quote";
-
     mapsInitialized = true;
 }
 
@@ -183,109 +67,122 @@ bool KeyMapping::IsModifierKey(DWORD vkCode) {
            vkCode == VK_LWIN || vkCode == VK_RWIN;
 }
 
-void KeyMapping::TrackKeyPress(DWORD vkCode, const std::vector<DWORD>& remappedKeys) {
+void KeyMapping::TrackKeyPress(DWORD vkCode, const uint8_t* remappedKeys, uint32_t remappedCount) {
     auto now = std::chrono::steady_clock::now();
     auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
         now.time_since_epoch()
     ).count();
 
-    KeyState state;
-    state.isPressed = true;
-    state.isModifier = IsModifierKey(vkCode);
-    state.pressTime = timestamp;
-    state.remappedTo = remappedKeys;
-
-    keyStates[vkCode] = state;
-    releaseOrder.push(vkCode);
+    keyStates.Press(vkCode, IsModifierKey(vkCode), timestamp, remappedKeys, remappedCount);
 }
 
 void KeyMapping::TrackKeyRelease(DWORD vkCode) {
-    auto it = keyStates.find(vkCode);
-    if (it != keyStates.end()) {
+    if (keyStates.IsPressed(vkCode)) {
         // Release remapped keys in reverse order
         ReleaseRemappedKeys(vkCode);
-        keyStates.erase(it);
+        keyStates.Release(vkCode);
     }
 }
 
 void KeyMapping::ReleaseRemappedKeys(DWORD vkCode) {
-    auto it = keyStates.find(vkCode);
-    if (it == keyStates.end()) return;
+    if (!keyStates.IsPressed(vkCode)) return;
 
-    const auto& remappedKeys = it->second.remappedTo;
+    const KeyState& state = keyStates.Get(vkCode);
     // Release keys in reverse order
-    for (auto rit = remappedKeys.rbegin(); rit != remappedKeys.rend(); ++rit) {
-        SimulateKeyRelease(*rit);
-        auto stateIt = keyStates.find(*rit);
-        if (stateIt != keyStates.end()) {
-            keyStates.erase(stateIt);
-        }
+    for (int i = state.remappedCount - 1; i >= 0; i--) {
+        DWORD targetVK = state.remappedTo[i];
+        SimulateKeyRelease(targetVK);
+        keyStates.Release(targetVK);
     }
 }
 
-void KeyMapping::ProcessRemaps(
+std::vector<std::pair<uint32_t, std::vector<uint32_t>>> KeyMapping::CompileRemaps(
     const std::map<std::string, std::vector<std::string>>& remaps,
-    DWORD vkCode,
-    bool isKeyDown,
     int maxChainLength
 ) {
-    // Update CapsLock state when processing remaps
-    UpdateCapsLockState(remaps);
-    
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> entries;
+    for (const auto& [keyName, targetNames] : remaps) {
+        DWORD sourceVK = GetVirtualKeyCode(keyName);
+        if (sourceVK == 0) continue;
+
+        // Circular chains are rejected here once instead of on every key press
+        std::set<DWORD> visited;
+        if (IsCircularRemap(sourceVK, remaps, visited, 0, maxChainLength)) {
+            printf("Warning: Circular remap detected for key %s\n", keyName.c_str());
+            continue;
+        }
+
+        // Convert target key names to VK codes
+        std::vector<uint32_t> targetKeys;
+        for (const auto& targetKeyName : targetNames) {
+            DWORD targetVK = GetVirtualKeyCode(targetKeyName);
+            if (targetVK != 0) {
+                targetKeys.push_back(targetVK);
+            }
+        }
+
+        if (targetKeys.size() > RemapTable::MAX_TARGETS) {
+            printf("Warning: Remap for key %s truncated to %d targets\n",
+                   keyName.c_str(), RemapTable::MAX_TARGETS);
+        }
+
+        if (!targetKeys.empty()) {
+            entries.emplace_back(sourceVK, std::move(targetKeys));
+        }
+    }
+
+    return entries;
+}
+
+void KeyMapping::SetCompiledRemaps(const std::vector<std::pair<uint32_t, std::vector<uint32_t>>>& entries) {
+    // Build outside the lock so the capture thread only waits for the swap
+    RemapTable table;
+    table.Build(entries);
+
+    std::lock_guard<std::mutex> lock(remapMutex);
+    std::swap(remapTable, table);
+}
+
+uint32_t KeyMapping::CopyRemapTargets(DWORD vkCode, uint8_t* targets) {
+    std::lock_guard<std::mutex> lock(remapMutex);
+    uint32_t targetCount = 0;
+    const uint8_t* tableTargets = remapTable.GetTargets(vkCode, targetCount);
+    std::copy(tableTargets, tableTargets + targetCount, targets);
+    return targetCount;
+}
+
+void KeyMapping::ProcessRemaps(DWORD vkCode, bool isKeyDown) {
+    TRACE_SCOPE("ProcessRemaps");
+
+    // Copy the targets out so the lock isn't held across SendInput
+    uint8_t targetKeys[RemapTable::MAX_TARGETS];
+    uint32_t targetCount = CopyRemapTargets(vkCode, targetKeys);
+
     // Handle CapsLock specially if it's remapped
-    if (vkCode == VK_CAPITAL && capsLockRemapped) {
+    if (vkCode == VK_CAPITAL && targetCount > 0) {
         HandleCapsLockRemap(isKeyDown);
     }
     
     // Skip if already processed to prevent recursion
-    if (processedKeys.find(vkCode) != processedKeys.end()) {
-        return;
-    }
-    
-    // Mark as processed
-    processedKeys.insert(vkCode);
-    
-    // Get the key name for lookup
-    std::string keyName = GetKeyName(vkCode);
-    if (keyName.empty()) {
-        processedKeys.erase(vkCode);
+    if (processedKeys.Test(vkCode)) {
         return;
     }
     
     // Check if this key has remaps
-    auto remapIt = remaps.find(keyName);
-    if (remapIt == remaps.end()) {
-        processedKeys.erase(vkCode);
+    if (targetCount == 0) {
         return;
     }
     
-    // Convert target key names to VK codes
-    std::vector<DWORD> targetKeys;
-    for (const auto& targetKeyName : remapIt->second) {
-        DWORD targetVK = GetVirtualKeyCode(targetKeyName);
-        if (targetVK != 0) {
-            targetKeys.push_back(targetVK);
-        }
-    }
-    
-    // Store active remaps for this key
-    activeRemaps[vkCode] = targetKeys;
-    
-    // Check for circular remaps
-    std::set<DWORD> visited;
-    if (IsCircularRemap(vkCode, remaps, visited, 0, maxChainLength)) {
-        printf("Warning: Circular remap detected for key %s\n", keyName.c_str());
-        processedKeys.erase(vkCode);
-        return;
-    }
+    // Mark as processed
+    processedKeys.Set(vkCode);
     
     if (isKeyDown) {
         // Track the key press and its remapped keys
-        TrackKeyPress(vkCode, targetKeys);
+        TrackKeyPress(vkCode, targetKeys, targetCount);
         
         // Process the remapped keys in order
-        for (DWORD targetVK : targetKeys) {
-            SimulateKeyPress(targetVK);
+        for (uint32_t i = 0; i < targetCount; i++) {
+            SimulateKeyPress(targetKeys[i]);
         }
     } else {
         // Release keys and clean up state
@@ -293,22 +190,23 @@ void KeyMapping::ProcessRemaps(
     }
     
     // Clear processed flag
-    processedKeys.erase(vkCode);
+    processedKeys.Reset(vkCode);
 }
 
 bool KeyMapping::IsKeyRemapped(DWORD vkCode) {
-    return activeRemaps.find(vkCode) != activeRemaps.end();
+    std::lock_guard<std::mutex> lock(remapMutex);
+    return remapTable.HasRemap(vkCode);
 }
 
 std::vector<DWORD> KeyMapping::GetRemappedKeys(DWORD vkCode) {
-    auto it = activeRemaps.find(vkCode);
-    return it != activeRemaps.end() ? it->second : std::vector<DWORD>();
+    uint8_t targetKeys[RemapTable::MAX_TARGETS];
+    uint32_t targetCount = CopyRemapTargets(vkCode, targetKeys);
+    return std::vector<DWORD>(targetKeys, targetKeys + targetCount);
 }
 
 void KeyMapping::SimulateKeyPress(DWORD vkCode) {
     // Don't simulate if key is already pressed
-    auto it = keyStates.find(vkCode);
-    if (it != keyStates.end() && it->second.isPressed) {
+    if (keyStates.IsPressed(vkCode)) {
         return;
     }
 
@@ -316,6 +214,7 @@ void KeyMapping::SimulateKeyPress(DWORD vkCode) {
     input.type = INPUT_KEYBOARD;
     input.ki.wVk = vkCode;
     input.ki.dwFlags = 0; // Key press
+    TRACE_SCOPE("SendInput");
     SendInput(1, &input, sizeof(INPUT));
 }
 
@@ -324,6 +223,7 @@ void KeyMapping::SimulateKeyRelease(DWORD vkCode) {
     input.type = INPUT_KEYBOARD;
     input.ki.wVk = vkCode;
     input.ki.dwFlags = KEYEVENTF_KEYUP;
+    TRACE_SCOPE("SendInput");
     SendInput(1, &input, sizeof(INPUT));
 }
 
@@ -375,7 +275,8 @@ bool KeyMapping::IsCircularRemap(
 }
 
 bool KeyMapping::IsCapsLockRemapped() {
-    return capsLockRemapped;
+    // Decided by what actually compiled, not by the key names in the config
+    return IsKeyRemapped(VK_CAPITAL);
 }
 
 void KeyMapping::BlockCapsLockToggle() {
@@ -390,25 +291,9 @@ void KeyMapping::BlockCapsLockToggle() {
     }
 }
 
-bool KeyMapping::ShouldReportCapsLock() {
-    return reportCapsLock;
-}
-
 void KeyMapping::HandleCapsLockRemap(bool isKeyDown) {
     if (isKeyDown) {
         // Block the toggle behavior
         BlockCapsLockToggle();
     }
 }
-
-void KeyMapping::UpdateCapsLockState(const std::map<std::string, std::vector<std::string>>& remaps) {
-    // Check if CapsLock is being remapped
-    auto it = remaps.find("CapsLock");
-    if (it == remaps.end()) {
-        it = remaps.find("Capital"); // Check alternate name
-    }
-    
-    capsLockRemapped = (it != remaps.end());
-    // Only report CapsLock if it's not being remapped to something else
-    reportCapsLock = !capsLockRemapped;
-} 
\ No newline at end of file
@@ -2,56 +2,55 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
-#include <queue>
 #include <windows.h>
-
-struct KeyState {
-    bool isPressed;
-    bool isModifier;
-    long long pressTime;
-    std::vector<DWORD> remappedTo;
-};
+#include "key_snapshot.h"
+#include "key_state_table.h"
 
 class KeyMapping {
 public:
     static DWORD GetVirtualKeyCode(const std::string& keyName);
     static std::string GetKeyName(DWORD vkCode);
     
-    // Remap processing
-    static void ProcessRemaps(
+    // Resolve remap names to VKs, dropping circular chains; config time only
+    static std::vector<std::pair<uint32_t, std::vector<uint32_t>>> CompileRemaps(
         const std::map<std::string, std::vector<std::string>>& remaps,
-        DWORD vkCode,
-        bool isKeyDown,
         int maxChainLength
     );
+
+    // Install already-compiled remaps into the per-VK table; never on the hot path
+    static void SetCompiledRemaps(const std::vector<std::pair<uint32_t, std::vector<uint32_t>>>& entries);
+
+    // Remap processing
+    static void ProcessRemaps(DWORD vkCode, bool isKeyDown);
     
-    // Check if a key is being remapped
+    // Check if a key has a remap in the current config
     static bool IsKeyRemapped(DWORD vkCode);
     
     // Get the remapped keys for a given key
     static std::vector<DWORD> GetRemappedKeys(DWORD vkCode);
 
-    // CapsLock handling
+    // CapsLock handling; remapped only if the compiled table has a VK_CAPITAL entry
     static bool IsCapsLockRemapped();
     static void BlockCapsLockToggle();
-    static bool ShouldReportCapsLock();
 
 private:
     static std::map<std::string, DWORD> keyNameToVK;
     static std::map<DWORD, std::string> vkToKeyName;
-    static std::map<DWORD, std::vector<DWORD>> activeRemaps;
-    static std::map<DWORD, KeyState> keyStates;
-    static std::set<DWORD> processedKeys;
-    static std::queue<DWORD> releaseOrder;
-    static bool capsLockRemapped;
-    static bool reportCapsLock;
+    // Rebuilt on the JS thread while the capture thread reads it; every
+    // access goes through remapMutex
+    static RemapTable remapTable;
+    static std::mutex remapMutex;
+    static KeyStateTable keyStates;
+    static KeySnapshot processedKeys;
     
     static void InitializeMaps();
     static bool mapsInitialized;
     
     // Helper functions for remap processing
+    static uint32_t CopyRemapTargets(DWORD vkCode, uint8_t* targets);
     static void SimulateKeyPress(DWORD vkCode);
     static void SimulateKeyRelease(DWORD vkCode);
     static bool IsCircularRemap(
@@ -64,11 +63,10 @@ private:
     
     // Key state management
     static bool IsModifierKey(DWORD vkCode);
-    static void TrackKeyPress(DWORD vkCode, const std::vector<DWORD>& remappedKeys);
+    static void TrackKeyPress(DWORD vkCode, const uint8_t* remappedKeys, uint32_t remappedCount);
     static void TrackKeyRelease(DWORD vkCode);
     static void ReleaseRemappedKeys(DWORD vkCode);
     
     // CapsLock helpers
     static void HandleCapsLockRemap(bool isKeyDown);
-    static void UpdateCapsLockState(const std::map<std::string, std::vector<std::string>>& remaps);
 }; 
\ No newline at end of file
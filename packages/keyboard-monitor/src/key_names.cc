@@ -0,0 +1,124 @@
+#include "key_names.h"
+
+namespace {
+    std::vector<KeyNameEntry> BuildKeyNames() {
+        std::vector<KeyNameEntry> names;
+        auto add = [&names](const std::string& name, uint32_t vkCode, bool isDisplayName = true) {
+            names.push_back(KeyNameEntry{name, vkCode, isDisplayName});
+        };
+
+        // Basic keys
+        add("CapsLock", 0x14);             // VK_CAPITAL
+        add("Capital", 0x14, false);       // Support both names
+        add("Shift", 0x10);                // VK_SHIFT
+        add("Control", 0x11);              // VK_CONTROL
+        add("Alt", 0x12);                  // VK_MENU
+        add("Win", 0x5B);                  // VK_LWIN
+        add("Tab", 0x09);
+        add("Enter", 0x0D);
+        add("Space", 0x20);
+        add("Backspace", 0x08);
+        add("Delete", 0x2E);
+        add("Escape", 0x1B);
+
+        // Left/Right modifiers
+        add("LShift", 0xA0);
+        add("RShift", 0xA1);
+        add("LControl", 0xA2);
+        add("RControl", 0xA3);
+        add("LAlt", 0xA4);                 // VK_LMENU
+        add("RAlt", 0xA5);                 // VK_RMENU
+        add("LWin", 0x5B, false);
+        add("RWin", 0x5C, false);
+
+        // Function keys
+        for (int i = 1; i <= 12; i++) {
+            add("F" + std::to_string(i), 0x70 + i - 1);
+        }
+
+        // Number keys
+        for (int i = 0; i <= 9; i++) {
+            add(std::to_string(i), '0' + i);
+        }
+
+        // Letter keys
+        for (char c = 'A'; c <= 'Z'; c++) {
+            add(std::string(1, c), c);
+        }
+
+        // Navigation keys
+        add("Home", 0x24);
+        add("End", 0x23);
+        add("PageUp", 0x21);               // VK_PRIOR
+        add("PageDown", 0x22);             // VK_NEXT
+        add("Insert", 0x2D);
+        add("Left", 0x25);
+        add("Right", 0x27);
+        add("Up", 0x26);
+        add("Down", 0x28);
+
+        // Additional keys
+        add("NumLock", 0x90);
+        add("ScrollLock", 0x91);           // VK_SCROLL
+        add("PrintScreen", 0x2C);          // VK_SNAPSHOT
+        add("Pause", 0x13);
+        add("Semicolon", 0xBA);            // VK_OEM_1
+        add("Equals", 0xBB);               // VK_OEM_PLUS
+        add("Comma", 0xBC);
+        add("Minus", 0xBD);
+        add("Period", 0xBE);
+        add("Slash", 0xBF);                // VK_OEM_2
+        add("Backtick", 0xC0);             // VK_OEM_3
+        add("OpenBracket", 0xDB);          // VK_OEM_4
+        add("Backslash", 0xDC);            // VK_OEM_5
+        add("CloseBracket", 0xDD);         // VK_OEM_6
+        add("Quote", 0xDE);                // VK_OEM_7
+
+        return names;
+    }
+}
+
+const std::vector<KeyNameEntry>& KeyNames::All() {
+    static const std::vector<KeyNameEntry> names = BuildKeyNames();
+    return names;
+}
+
+bool KeyNames::IsSystemKey(uint32_t vk) {
+    return vk == 0 ||
+           (vk >= 0x01 && vk <= 0x06) ||   // Mouse buttons and VK_CANCEL
+           vk == 0x0C || vk == 0x1F ||     // VK_CLEAR, VK_MODECHANGE
+           vk == 0x29 || vk == 0x2B ||     // VK_SELECT, VK_EXECUTE
+           vk == 0x2F ||                   // VK_HELP
+           (vk >= 0xA6 && vk <= 0xB7) ||   // Browser/media keys
+           (vk >= 0xE5 && vk <= 0xE7) ||   // IME keys through VK_PACKET
+           (vk >= 0xF6 && vk <= 0xFD);     // VK_ATTN through VK_PA1
+}
+
+KeySnapshot KeyNames::BuildCaptureMask() {
+    // Unnamed keys are never reported to JS, so don't poll them
+    KeySnapshot mask;
+    for (const KeyNameEntry& entry : All()) {
+        if (entry.isDisplayName && entry.vkCode < KeySnapshot::KEY_COUNT && !IsSystemKey(entry.vkCode)) {
+            mask.Set(entry.vkCode);
+        }
+    }
+    return mask;
+}
+
+uint64_t KeyNames::Hash() {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ULL;
+        }
+    };
+    for (const KeyNameEntry& entry : All()) {
+        mix(entry.name.c_str(), entry.name.size() + 1);
+        mix(&entry.vkCode, sizeof(entry.vkCode));
+        uint8_t isDisplayName = entry.isDisplayName;
+        mix(&isDisplayName, 1);
+    }
+    return hash;
+}
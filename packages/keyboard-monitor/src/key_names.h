@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "key_snapshot.h"
+
+struct KeyNameEntry {
+    std::string name;
+    uint32_t vkCode;
+    bool isDisplayName;  // the name reported to JS; otherwise a lookup alias
+};
+
+// The key-name table behind KeyMapping, kept free of windows.h so the capture
+// mask, the compiled-config cache and the Linux harness all derive from the
+// same list. VK codes are the fixed Windows values.
+class KeyNames {
+public:
+    // Every name the addon accepts, display names first for each key
+    static const std::vector<KeyNameEntry>& All();
+
+    // Named keys minus mouse, media and IME codes; the VKs worth polling
+    static KeySnapshot BuildCaptureMask();
+
+    // FNV-1a over every (name, vkCode, isDisplayName) entry
+    static uint64_t Hash();
+
+    // Mouse, media, IME and other codes that are never polled
+    static bool IsSystemKey(uint32_t vkCode);
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KEY_SNAPSHOT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// 256-bit set of virtual key codes, one bit per VK.
+// Kept free of Windows headers so the diff kernel can be built and measured anywhere.
+struct alignas(16) KeySnapshot {
+    static const int KEY_COUNT = 256;
+    static const int WORD_COUNT = KEY_COUNT / 64;
+
+    uint64_t words[WORD_COUNT] = {0, 0, 0, 0};
+
+    void Set(uint32_t vk) { words[(vk >> 6) & 3] |= 1ULL << (vk & 63); }
+    void Reset(uint32_t vk) { words[(vk >> 6) & 3] &= ~(1ULL << (vk & 63)); }
+    void Toggle(uint32_t vk) { words[(vk >> 6) & 3] ^= 1ULL << (vk & 63); }
+    bool Test(uint32_t vk) const { return (words[(vk >> 6) & 3] >> (vk & 63)) & 1; }
+
+    void Clear() {
+        for (int i = 0; i < WORD_COUNT; i++) words[i] = 0;
+    }
+
+    bool Any() const {
+        return (words[0] | words[1] | words[2] | words[3]) != 0;
+    }
+
+    KeySnapshot& operator|=(const KeySnapshot& other) {
+        for (int i = 0; i < WORD_COUNT; i++) words[i] |= other.words[i];
+        return *this;
+    }
+
+    KeySnapshot& operator&=(const KeySnapshot& other) {
+        for (int i = 0; i < WORD_COUNT; i++) words[i] &= other.words[i];
+        return *this;
+    }
+
+    // this &= ~other
+    KeySnapshot& AndNot(const KeySnapshot& other) {
+        for (int i = 0; i < WORD_COUNT; i++) words[i] &= ~other.words[i];
+        return *this;
+    }
+
+    bool Intersects(const KeySnapshot& other) const {
+        return ((words[0] & other.words[0]) | (words[1] & other.words[1]) |
+                (words[2] & other.words[2]) | (words[3] & other.words[3])) != 0;
+    }
+
+    bool IsSubsetOf(const KeySnapshot& other) const {
+        return ((words[0] & ~other.words[0]) | (words[1] & ~other.words[1]) |
+                (words[2] & ~other.words[2]) | (words[3] & ~other.words[3])) == 0;
+    }
+
+    bool operator==(const KeySnapshot& other) const {
+        return ((words[0] ^ other.words[0]) | (words[1] ^ other.words[1]) |
+                (words[2] ^ other.words[2]) | (words[3] ^ other.words[3])) == 0;
+    }
+    bool operator!=(const KeySnapshot& other) const { return !(*this == other); }
+};
+
+struct KeySnapshotDiff {
+    KeySnapshot pressed;
+    KeySnapshot released;
+
+    bool Any() const { return pressed.Any() || released.Any(); }
+};
+
+inline int CountTrailingZeros64(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (_BitScanForward(&index, static_cast<unsigned long>(value))) {
+        return static_cast<int>(index);
+    }
+    _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+    return static_cast<int>(index) + 32;
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+// Calls fn(vk) for every set bit, lowest VK first
+template <typename Fn>
+inline void ForEachKey(const KeySnapshot& keys, Fn&& fn) {
+    for (int i = 0; i < KeySnapshot::WORD_COUNT; i++) {
+        uint64_t bits = keys.words[i];
+        while (bits) {
+            fn(static_cast<uint32_t>(i * 64 + CountTrailingZeros64(bits)));
+            bits &= bits - 1;
+        }
+    }
+}
+
+// Compares a new snapshot against the previous held state.
+//   pressed  = current & reportMask & ~previous
+//   released = previous & ~current
+// Keys outside reportMask are never reported as new presses, but a key that was
+// already held still reports its release. Returns true if anything changed.
+inline bool DiffKeySnapshots(
+    const KeySnapshot& previous,
+    const KeySnapshot& current,
+    const KeySnapshot& reportMask,
+    KeySnapshotDiff& diff
+) {
+#if defined(KEY_SNAPSHOT_SSE2)
+    __m128i changedAny = _mm_setzero_si128();
+    for (int i = 0; i < KeySnapshot::WORD_COUNT; i += 2) {
+        __m128i prev = _mm_load_si128(reinterpret_cast<const __m128i*>(&previous.words[i]));
+        __m128i curr = _mm_load_si128(reinterpret_cast<const __m128i*>(&current.words[i]));
+        __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(&reportMask.words[i]));
+
+        // Only bits that flipped can be presses or releases
+        __m128i changed = _mm_xor_si128(prev, curr);
+        __m128i pressed = _mm_and_si128(_mm_and_si128(changed, curr), mask);
+        __m128i released = _mm_and_si128(changed, prev);
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(&diff.pressed.words[i]), pressed);
+        _mm_store_si128(reinterpret_cast<__m128i*>(&diff.released.words[i]), released);
+        changedAny = _mm_or_si128(changedAny, _mm_or_si128(pressed, released));
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(changedAny, _mm_setzero_si128())) != 0xFFFF;
+#else
+    uint64_t changedAny = 0;
+    for (int i = 0; i < KeySnapshot::WORD_COUNT; i++) {
+        uint64_t changed = previous.words[i] ^ current.words[i];
+        diff.pressed.words[i] = changed & current.words[i] & reportMask.words[i];
+        diff.released.words[i] = changed & previous.words[i];
+        changedAny |= diff.pressed.words[i] | diff.released.words[i];
+    }
+    return changedAny != 0;
+#endif
+}
@@ -0,0 +1,67 @@
+#include "key_state_table.h"
+#include <algorithm>
+
+RemapTable::RemapTable() {
+    offsets.fill(0);
+    counts.fill(0);
+}
+
+void RemapTable::Build(const std::vector<std::pair<uint32_t, std::vector<uint32_t>>>& entries) {
+    Clear();
+
+    // Size the arena up front so it is allocated exactly once per config
+    size_t total = 0;
+    for (const auto& [source, targets] : entries) {
+        total += std::min<size_t>(targets.size(), MAX_TARGETS);
+    }
+    arena.reserve(total);
+
+    for (const auto& [source, targets] : entries) {
+        if (source >= KEY_COUNT || counts[source] != 0) continue;
+
+        offsets[source] = static_cast<uint16_t>(arena.size());
+        for (uint32_t target : targets) {
+            if (target == 0 || target >= KEY_COUNT) continue;
+            if (counts[source] == MAX_TARGETS) break;
+            arena.push_back(static_cast<uint8_t>(target));
+            counts[source]++;
+        }
+    }
+}
+
+void RemapTable::Clear() {
+    arena.clear();
+    offsets.fill(0);
+    counts.fill(0);
+}
+
+const uint8_t* RemapTable::GetTargets(uint32_t vkCode, uint32_t& count) const {
+    if (!HasRemap(vkCode)) {
+        count = 0;
+        return nullptr;
+    }
+    count = counts[vkCode];
+    return arena.data() + offsets[vkCode];
+}
+
+void KeyStateTable::Press(uint32_t vkCode, bool isModifier, long long pressTime,
+                          const uint8_t* remappedTo, uint32_t remappedCount) {
+    if (vkCode >= KEY_COUNT) return;
+
+    KeyState& state = states[vkCode];
+    state.isPressed = true;
+    state.isModifier = isModifier;
+    state.pressTime = pressTime;
+    state.remappedCount = static_cast<uint8_t>(
+        std::min<uint32_t>(remappedCount, RemapTable::MAX_TARGETS));
+    std::copy(remappedTo, remappedTo + state.remappedCount, state.remappedTo.begin());
+}
+
+void KeyStateTable::Release(uint32_t vkCode) {
+    if (vkCode >= KEY_COUNT) return;
+    states[vkCode] = KeyState();
+}
+
+void KeyStateTable::Clear() {
+    states.fill(KeyState());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Remap targets for every source VK, compiled once at config time.
+// All target lists live in a single arena sized by Build, so lookups on the
+// hot path never allocate and never touch key names.
+//
+// Not thread-safe: Build must not run while another thread reads the table.
+// KeyMapping builds a fresh table and swaps it in under a lock.
+class RemapTable {
+public:
+    static const int KEY_COUNT = 256;
+    static const int MAX_TARGETS = 8;
+
+    RemapTable();
+
+    // entries: (sourceVK, targetVKs). Targets beyond MAX_TARGETS are dropped.
+    void Build(const std::vector<std::pair<uint32_t, std::vector<uint32_t>>>& entries);
+    void Clear();
+
+    bool HasRemap(uint32_t vkCode) const {
+        return vkCode < KEY_COUNT && counts[vkCode] != 0;
+    }
+
+    // Returns the target list for vkCode and writes its length to count
+    const uint8_t* GetTargets(uint32_t vkCode, uint32_t& count) const;
+
+private:
+    std::vector<uint8_t> arena;
+    std::array<uint16_t, KEY_COUNT> offsets;
+    std::array<uint8_t, KEY_COUNT> counts;
+};
+
+struct KeyState {
+    bool isPressed = false;
+    bool isModifier = false;
+    long long pressTime = 0;
+    uint8_t remappedCount = 0;
+    // Copied at press time so a config change cannot strand a held remap
+    std::array<uint8_t, RemapTable::MAX_TARGETS> remappedTo{};
+};
+
+// Fixed-size per-VK press state. Never allocates after construction.
+class KeyStateTable {
+public:
+    static const int KEY_COUNT = 256;
+
+    void Press(uint32_t vkCode, bool isModifier, long long pressTime,
+               const uint8_t* remappedTo, uint32_t remappedCount);
+    void Release(uint32_t vkCode);
+    void Clear();
+
+    bool IsPressed(uint32_t vkCode) const {
+        return vkCode < KEY_COUNT && states[vkCode].isPressed;
+    }
+
+    const KeyState& Get(uint32_t vkCode) const { return states[vkCode & 0xFF]; }
+
+private:
+    std::array<KeyState, KEY_COUNT> states{};
+};
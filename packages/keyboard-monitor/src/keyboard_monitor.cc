@@ -4,6 +4,9 @@
 
 #include "keyboard_monitor.h"
 #include "key_mapping.h"
+#include "key_names.h"
+#include "pipeline_stages.h"
+#include "trace_events.h"
 
 KeyboardMonitor* KeyboardMonitor::instance = nullptr;
 
@@ -12,6 +15,11 @@ Napi::Object KeyboardMonitor::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("start", &KeyboardMonitor::Start),
         InstanceMethod("stop", &KeyboardMonitor::Stop),
         InstanceMethod("setConfig", &KeyboardMonitor::SetConfig),
+        InstanceMethod("getHoldDuration", &KeyboardMonitor::GetHoldDuration),
+        InstanceMethod("getPipelineStats", &KeyboardMonitor::GetPipelineStats),
+        InstanceMethod("writeTrace", &KeyboardMonitor::WriteTrace),
+        InstanceMethod("saveCompiledConfig", &KeyboardMonitor::SaveCompiledConfig),
+        InstanceMethod("loadCompiledConfig", &KeyboardMonitor::LoadCompiledConfig),
     });
 
     Napi::FunctionReference* constructor = new Napi::FunctionReference();
@@ -25,7 +33,20 @@ Napi::Object KeyboardMonitor::Init(Napi::Env env, Napi::Object exports) {
 KeyboardMonitor::KeyboardMonitor(const Napi::CallbackInfo& info) 
     : Napi::ObjectWrap<KeyboardMonitor>(info) {
     instance = this;
+    captureMask = KeyNames::BuildCaptureMask();
+    expiredHolds.reserve(HoldTimerQueue::KEY_COUNT);
     Napi::Env env = info.Env();
+    TraceRecorder::SetThreadName("js");
+
+    // Build the pipeline; placement of the frame builder and sinks is chosen at Start
+    auto chords = std::make_unique<ChordStage>(*this);
+    chordStage = chords.get();
+    inputStages.push_back(std::move(chords));
+    auto moves = std::make_unique<MoveStage>(*this);
+    moveStage = moves.get();
+    inputStages.push_back(std::move(moves));
+    inputStages.push_back(std::make_unique<KeyFilterStage>(captureMask));
+    frameSinks.push_back(std::make_unique<JsEmitSink>(*this));
 
     // Create thread-safe function for emitting events
     tsfn = Napi::ThreadSafeFunction::New(
@@ -43,149 +64,197 @@ KeyboardMonitor::~KeyboardMonitor() {
         WaitForSingleObject(pollingThread, INFINITE);
         CloseHandle(pollingThread);
     }
+    StopWorker();
+    if (workerWakeEvent) {
+        CloseHandle(workerWakeEvent);
+    }
     if (tsfn) {
         tsfn.Release();
     }
 }
 
-void KeyboardMonitor::ProcessKeyEvent(DWORD vkCode, bool isKeyDown) {
+void KeyboardMonitor::PollKeyboardState() {
     if (!isEnabled) return;
+    TRACE_SCOPE("PollKeyboardState");
 
-    // Skip if the key doesn't have a valid mapping
-    std::string keyName = KeyMapping::GetKeyName(vkCode);
-    if (keyName.empty()) return;
+    auto now = std::chrono::steady_clock::now();
+    long long nowMs = GetTimestampMs();
+    KeyInputEvent tick{0, false, nowMs};
+
+    moveStage->Advance(nowMs);
+
+    DispatchToFrameBuilder({PipelineMessage::Kind::BeginTick, tick});
+
+    // Snapshot all candidate keys, then diff against what we reported last poll
+    KeySnapshot snapshot;
+    CaptureKeySnapshot(snapshot);
 
-    // Open gate and update last key event time on any key event
-    OpenGate();
+    KeySnapshotDiff diff;
+    if (DiffKeySnapshots(reportedKeys, snapshot, captureMask, diff)) {
+        reportedKeys |= diff.pressed;
+        reportedKeys.AndNot(diff.released);
+
+        auto dispatch = [this, nowMs](uint32_t vk, bool isKeyDown) {
+            TRACE_INSTANT(isKeyDown ? "KeyDown" : "KeyUp");
+            KeyInputEvent event{vk, isKeyDown, nowMs};
+            sourceCounters.Count(true);
+            if (RunInputStages(event)) {
+                DispatchKeyEvent(event);
+            }
+        };
+        ForEachKey(diff.released, [&dispatch](uint32_t vk) { dispatch(vk, false); });
+        ForEachKey(diff.pressed, [&dispatch](uint32_t vk) { dispatch(vk, true); });
+    }
+
+    DispatchToFrameBuilder({PipelineMessage::Kind::EndTick, tick, dispatchedKeys});
+
+    if (frameBuilderPlacement == StagePlacement::Worker) {
+        WakeWorker();
+    }
+
+    lastPollTime = now;
+}
+
+bool KeyboardMonitor::RunInputStages(KeyInputEvent& event) {
+    for (auto& stage : inputStages) {
+        if (!stage->Run(event)) return false;
+    }
+    return true;
+}
+
+void KeyboardMonitor::DispatchKeyEvent(const KeyInputEvent& event) {
+    if (event.isKeyDown) {
+        dispatchedKeys.Set(event.vkCode);
+    } else {
+        dispatchedKeys.Reset(event.vkCode);
+    }
+    DispatchToFrameBuilder({PipelineMessage::Kind::Event, event});
+}
+
+void KeyboardMonitor::DispatchToFrameBuilder(const PipelineMessage& message) {
+    if (frameBuilderPlacement == StagePlacement::Capture) {
+        HandlePipelineMessage(message);
+    } else {
+        eventQueue.TryPush(message);
+    }
+}
+
+void KeyboardMonitor::HandlePipelineMessage(const PipelineMessage& message) {
+    switch (message.kind) {
+        case PipelineMessage::Kind::BeginTick:
+            BeginFrameTick();
+            break;
+        case PipelineMessage::Kind::Event:
+            ApplyKeyEvent(message.event);
+            break;
+        case PipelineMessage::Kind::EndTick:
+            ResyncFrameHeld(message.heldKeys, message.event.timestampMs);
+            EndFrameTick(message.event.timestampMs);
+            break;
+    }
+}
 
+void KeyboardMonitor::BeginFrameTick() {
     auto now = std::chrono::steady_clock::now();
     auto frameDelta = std::chrono::duration_cast<std::chrono::microseconds>(
         now - lastFrameTime
     ).count();
 
+    // Update gate state
+    UpdateGateState();
+
     // Create new frame if needed
-    if (frameDelta >= FRAME_TIME_MICROS) {
+    isFrameDue = frameDelta >= FRAME_TIME_MICROS;
+    if (isFrameDue) {
         CreateNewFrame();
     }
+}
 
+void KeyboardMonitor::ApplyKeyEvent(const KeyInputEvent& event) {
     auto& currentFrame = frameBuffer[currentFrameIndex];
-    
-    // Handle remapping if enabled
-    if (isRemapperEnabled && !KeyMapping::IsKeyRemapped(vkCode)) {
-        KeyMapping::ProcessRemaps(remaps, vkCode, isKeyDown, maxRemapChainLength);
-        if (KeyMapping::IsKeyRemapped(vkCode) && 
-            !(vkCode == VK_CAPITAL && KeyMapping::ShouldReportCapsLock())) {
-            return;
-        }
-    }
-    
-    if (isKeyDown) {
-        if (currentFrame.held.find(vkCode) == currentFrame.held.end()) {
-            currentFrame.justPressed.insert(vkCode);
-            currentFrame.held.insert(vkCode);
+    DWORD vkCode = event.vkCode;
+    bool applied = false;
+
+    if (event.isKeyDown) {
+        if (!currentFrame.held.Test(vkCode)) {
+            currentFrame.justPressed.Set(vkCode);
+            currentFrame.held.Set(vkCode);
             keyPressStartFrames[vkCode] = totalFrames;
+            TrackHoldPress(vkCode, event.timestampMs);
             
             // Update event info
             currentFrame.event.type = "keydown";
             currentFrame.event.key = vkCode;
+            applied = true;
         }
     } else {
-        if (currentFrame.held.find(vkCode) != currentFrame.held.end()) {
-            currentFrame.justReleased.insert(vkCode);
-            currentFrame.held.erase(vkCode);
-            keyPressStartFrames.erase(vkCode);
+        if (currentFrame.held.Test(vkCode)) {
+            currentFrame.justReleased.Set(vkCode);
+            currentFrame.held.Reset(vkCode);
+            TrackHoldRelease(vkCode);
             
             // Update event info
             currentFrame.event.type = "keyup";
             currentFrame.event.key = vkCode;
+            applied = true;
         }
     }
 
-    // Update hold durations in frames
-    for (const auto& key : currentFrame.held) {
-        if (keyPressStartFrames.find(key) != keyPressStartFrames.end()) {
-            currentFrame.holdDurations[key] = GetFramesSince(keyPressStartFrames[key]);
-        }
+    if (applied) {
+        OpenGate(); // Open gate on any press or release
     }
-
-    EmitFrame(currentFrame);
+    frameBuilderCounters.Count(applied);
 }
 
-void KeyboardMonitor::PollKeyboardState() {
-    if (!isEnabled) return;
-
-    auto now = std::chrono::steady_clock::now();
-    auto frameDelta = std::chrono::duration_cast<std::chrono::microseconds>(
-        now - lastFrameTime
-    ).count();
+void KeyboardMonitor::ResyncFrameHeld(const KeySnapshot& heldKeys, long long nowMs) {
+    // Replay what a dropped Event carried so no key stays stuck or skips justPressed
+    ResyncHeldKeys(frameBuffer[currentFrameIndex].held, heldKeys, captureMask,
+        [this, nowMs](uint32_t vk, bool isKeyDown) {
+            ApplyKeyEvent(KeyInputEvent{vk, isKeyDown, nowMs});
+        });
+}
 
-    // Update gate state
-    UpdateGateState();
+void KeyboardMonitor::EndFrameTick(long long nowMs) {
+    // Fire any hold thresholds whose deadline has passed
+    ExpireHoldTimers(nowMs);
 
-    // Create new frame if needed
-    if (frameDelta >= FRAME_TIME_MICROS) {
-        CreateNewFrame();
+    // Deliver frame if gate is open and we've reached the frame time
+    if (isGateOpen && isFrameDue) {
+        DeliverFrame(frameBuffer[currentFrameIndex]);
     }
+    isFrameDue = false;
+}
 
-    auto& currentFrame = frameBuffer[currentFrameIndex];
-    std::set<DWORD> currentKeys;
-
-    // Check all possible virtual key codes
-    for (int vk = 0; vk < 256; vk++) {
-        // Skip invalid or system keys
-        if (vk == 0 || vk == VK_PACKET || 
-            (vk >= VK_LBUTTON && vk <= VK_XBUTTON2) || // Skip mouse buttons
-            vk == VK_CANCEL || vk == VK_MODECHANGE ||
-            vk == VK_CLEAR || vk == VK_SELECT ||
-            vk == VK_EXECUTE || vk == VK_HELP ||
-            (vk >= VK_BROWSER_BACK && vk <= VK_LAUNCH_APP2) || // Skip browser/media keys
-            (vk >= VK_PROCESSKEY && vk <= VK_PACKET) || // Skip IME keys
-            vk == VK_ATTN || vk == VK_CRSEL || vk == VK_EXSEL ||
-            vk == VK_EREOF || vk == VK_PLAY || vk == VK_ZOOM ||
-            vk == VK_NONAME || vk == VK_PA1) {
-            continue;
-        }
-
-        SHORT keyState = GetAsyncKeyState(vk);
-        if (keyState & 0x8000) { // Key is pressed
-            std::string keyName = KeyMapping::GetKeyName(vk);
-            if (!keyName.empty()) {
-                if (vk == VK_CAPITAL && !KeyMapping::ShouldReportCapsLock()) {
-                    continue;
-                }
-                
-                currentKeys.insert(vk);
-                if (currentFrame.held.find(vk) == currentFrame.held.end()) {
-                    currentFrame.justPressed.insert(vk);
-                    currentFrame.held.insert(vk);
-                    keyPressStartFrames[vk] = totalFrames;
-                    OpenGate(); // Open gate on new key press
-                }
-            }
-        } else if (currentFrame.held.find(vk) != currentFrame.held.end()) {
-            currentFrame.justReleased.insert(vk);
-            currentFrame.held.erase(vk);
-            keyPressStartFrames.erase(vk);
-            OpenGate(); // Open gate on key release
-        }
-    }
+void KeyboardMonitor::DeliverFrame(const KeyboardFrame& currentFrame) {
+    // Hold durations are only materialized for frames that actually leave the builder
+    KeyboardFrame frame = currentFrame;
+    ForEachKey(frame.held, [this, &frame](uint32_t key) {
+        frame.holdDurations[key] = GetFramesSince(keyPressStartFrames[key]);
+    });
 
-    // Update hold durations in frames
-    for (const auto& key : currentFrame.held) {
-        if (keyPressStartFrames.find(key) != keyPressStartFrames.end()) {
-            currentFrame.holdDurations[key] = GetFramesSince(keyPressStartFrames[key]);
-        }
+    if (sinkPlacement == frameBuilderPlacement) {
+        RunFrameSinks(frame);
+    } else if (frameQueue.TryPush(frame)) {
+        WakeWorker();
     }
+}
 
-    // Emit frame if gate is open and we've reached the frame time
-    if (isGateOpen && frameDelta >= FRAME_TIME_MICROS) {
-        EmitFrame(currentFrame);
+void KeyboardMonitor::RunFrameSinks(const KeyboardFrame& frame) {
+    for (auto& sink : frameSinks) {
+        sink->Run(frame);
     }
+}
 
-    lastPollTime = now;
+void KeyboardMonitor::CaptureKeySnapshot(KeySnapshot& snapshot) const {
+    ForEachKey(captureMask, [&snapshot](uint32_t vk) {
+        if (GetAsyncKeyState(vk) & 0x8000) {
+            snapshot.Set(vk);
+        }
+    });
 }
 
 void KeyboardMonitor::CreateNewFrame() {
+    TRACE_SCOPE("CreateNewFrame");
     // Move to next frame in circular buffer
     currentFrameIndex = (currentFrameIndex + 1) % BUFFER_SIZE;
     totalFrames++;
@@ -193,9 +262,7 @@ void KeyboardMonitor::CreateNewFrame() {
     // Initialize new frame
     auto& newFrame = frameBuffer[currentFrameIndex];
     newFrame = KeyboardFrame(); // Clear previous frame data
-    newFrame.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()
-    ).count();
+    newFrame.timestamp = GetTimestampMs();
     newFrame.frameNumber = totalFrames;
     newFrame.gateOpen = isGateOpen;
 
@@ -203,13 +270,6 @@ void KeyboardMonitor::CreateNewFrame() {
     if (totalFrames > 1) {
         int prevIndex = (currentFrameIndex - 1 + BUFFER_SIZE) % BUFFER_SIZE;
         newFrame.held = frameBuffer[prevIndex].held;
-        
-        // Copy hold durations for held keys
-        for (const auto& key : newFrame.held) {
-            if (keyPressStartFrames.find(key) != keyPressStartFrames.end()) {
-                newFrame.holdDurations[key] = GetFramesSince(keyPressStartFrames[key]);
-            }
-        }
     }
 
     lastFrameTime = std::chrono::steady_clock::now();
@@ -219,11 +279,99 @@ int KeyboardMonitor::GetFramesSince(int startFrame) const {
     return totalFrames - startFrame;
 }
 
+long long KeyboardMonitor::GetTimestampMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+void KeyboardMonitor::TrackHoldPress(DWORD vkCode, long long nowMs) {
+    std::lock_guard<std::mutex> lock(holdTimersMutex);
+    holdTimers.OnKeyPressed(vkCode, nowMs);
+}
+
+void KeyboardMonitor::TrackHoldRelease(DWORD vkCode) {
+    std::lock_guard<std::mutex> lock(holdTimersMutex);
+    holdTimers.OnKeyReleased(vkCode);
+}
+
+void KeyboardMonitor::ExpireHoldTimers(long long nowMs) {
+    {
+        std::lock_guard<std::mutex> lock(holdTimersMutex);
+        if (holdTimers.NextDeadline() > nowMs) return;
+
+        holdTimers.Expire(nowMs, [this](const HoldReached& reached) {
+            expiredHolds.push_back(reached);
+        });
+    }
+
+    // Emitting can block on the JS queue; SetConfig must not wait behind it
+    for (const HoldReached& reached : expiredHolds) {
+        EmitHoldReached(reached);
+    }
+    expiredHolds.clear();
+}
+
+void KeyboardMonitor::EmitHoldReached(const HoldReached& reached) {
+    if (!tsfn || !isEnabled) return;
+    TRACE_INSTANT("HoldReached");
+
+    std::string keyName = KeyMapping::GetKeyName(reached.vkCode);
+    if (keyName.empty()) return;
+
+    auto jsCallback = [keyName, reached](Napi::Env env, Napi::Function jsCallback) {
+        Napi::Object holdObj = Napi::Object::New(env);
+        holdObj.Set("key", Napi::String::New(env, keyName));
+        holdObj.Set("thresholdMs", Napi::Number::New(env, reached.thresholdMs));
+        holdObj.Set("heldMs", Napi::Number::New(env, static_cast<double>(reached.heldMs)));
+
+        jsCallback.Call({Napi::String::New(env, "hold"), holdObj});
+    };
+
+    tsfn.BlockingCall(jsCallback);
+}
+
+void KeyboardMonitor::EmitChord(uint32_t chordId, DWORD vkCode) {
+    if (!tsfn || !isEnabled) return;
+    TRACE_INSTANT("ChordMatched");
+
+    std::string keyName = KeyMapping::GetKeyName(vkCode);
+    auto jsCallback = [chordId, keyName](Napi::Env env, Napi::Function jsCallback) {
+        Napi::Object chordObj = Napi::Object::New(env);
+        chordObj.Set("id", Napi::Number::New(env, chordId));
+        chordObj.Set("key", Napi::String::New(env, keyName));
+
+        jsCallback.Call({Napi::String::New(env, "chord"), chordObj});
+    };
+
+    tsfn.BlockingCall(jsCallback);
+}
+
+void KeyboardMonitor::EmitMove(const std::string& name, MovePhase phase, long long timestampMs) {
+    if (!tsfn || !isEnabled) return;
+    TRACE_INSTANT("MoveSignal");
+
+    const char* phaseName = phase == MovePhase::Started ? "start"
+        : phase == MovePhase::Confirmed ? "confirm" : "cancel";
+    auto jsCallback = [name, phaseName, timestampMs](Napi::Env env, Napi::Function jsCallback) {
+        Napi::Object moveObj = Napi::Object::New(env);
+        moveObj.Set("name", Napi::String::New(env, name));
+        moveObj.Set("phase", Napi::String::New(env, phaseName));
+        moveObj.Set("timestamp", Napi::Number::New(env, static_cast<double>(timestampMs)));
+
+        jsCallback.Call({Napi::String::New(env, "move"), moveObj});
+    };
+
+    tsfn.BlockingCall(jsCallback);
+}
+
 void KeyboardMonitor::EmitFrame(const KeyboardFrame& frame) {
     if (!tsfn || !isEnabled) return;
+    TRACE_SCOPE("EmitFrame");
 
     // Convert VK codes to key names
     auto jsCallback = [this, frame](Napi::Env env, Napi::Function jsCallback) {
+        TRACE_SCOPE("EmitFrame.js");
         Napi::Object frameObj = Napi::Object::New(env);
         Napi::Object stateObj = Napi::Object::New(env);
         Napi::Array justPressedArr = Napi::Array::New(env);
@@ -233,38 +381,38 @@ void KeyboardMonitor::EmitFrame(const KeyboardFrame& frame) {
 
         // Convert justPressed VK codes to key names
         uint32_t pressedIndex = 0;
-        for (const auto& vk : frame.justPressed) {
+        ForEachKey(frame.justPressed, [&](uint32_t vk) {
             std::string keyName = KeyMapping::GetKeyName(vk);
             if (!keyName.empty()) {
                 justPressedArr.Set(pressedIndex++, Napi::String::New(env, keyName));
             }
-        }
+        });
 
         // Convert held VK codes to key names
         uint32_t heldIndex = 0;
-        for (const auto& vk : frame.held) {
+        ForEachKey(frame.held, [&](uint32_t vk) {
             std::string keyName = KeyMapping::GetKeyName(vk);
             if (!keyName.empty()) {
                 heldArr.Set(heldIndex++, Napi::String::New(env, keyName));
             }
-        }
+        });
 
         // Convert justReleased VK codes to key names
         uint32_t releasedIndex = 0;
-        for (const auto& vk : frame.justReleased) {
+        ForEachKey(frame.justReleased, [&](uint32_t vk) {
             std::string keyName = KeyMapping::GetKeyName(vk);
             if (!keyName.empty()) {
                 justReleasedArr.Set(releasedIndex++, Napi::String::New(env, keyName));
             }
-        }
+        });
 
         // Convert hold durations
-        for (const auto& [vk, duration] : frame.holdDurations) {
+        ForEachKey(frame.held, [&](uint32_t vk) {
             std::string keyName = KeyMapping::GetKeyName(vk);
             if (!keyName.empty()) {
-                holdDurationsObj.Set(keyName, Napi::Number::New(env, duration));
+                holdDurationsObj.Set(keyName, Napi::Number::New(env, frame.holdDurations[vk]));
             }
-        }
+        });
 
         // Build state object
         stateObj.Set("justPressed", justPressedArr);
@@ -301,6 +449,15 @@ void KeyboardMonitor::EmitFrame(const KeyboardFrame& frame) {
 
 Napi::Value KeyboardMonitor::Start(const Napi::CallbackInfo& info) {
     if (!isPolling) {
+        frameBuilderPlacement = activeConfig.frameBuilderPlacement;
+        // Sinks can't run upstream of the frame builder
+        sinkPlacement = frameBuilderPlacement == StagePlacement::Worker
+            ? StagePlacement::Worker
+            : activeConfig.sinkPlacement;
+        if (UsesWorker()) {
+            StartWorker();
+        }
+
         isPolling = true;
         pollingThread = CreateThread(
             NULL,
@@ -327,6 +484,7 @@ Napi::Value KeyboardMonitor::Stop(const Napi::CallbackInfo& info) {
         WaitForSingleObject(pollingThread, INFINITE);
         CloseHandle(pollingThread);
         pollingThread = NULL;
+        StopWorker();
         isEnabled = false;
     }
     return info.Env().Undefined();
@@ -342,10 +500,19 @@ Napi::Value KeyboardMonitor::SetConfig(const Napi::CallbackInfo& info) {
 
     Napi::Object config = info[0].As<Napi::Object>();
 
+    // Fields absent from config keep their current values, unless replace is
+    // set: then they go back to defaults, so the result depends on config alone
+    bool isReplace = info.Length() > 1 && info[1].IsBoolean() && info[1].As<Napi::Boolean>().Value();
+    if (isReplace) {
+        activeConfig = CompiledConfig();
+    }
+    bool hasRemapChanges = isReplace;
+
     // Get remaps if present
     if (config.Has("remaps") && config.Get("remaps").IsObject()) {
+        hasRemapChanges = true;
         Napi::Object remapsObj = config.Get("remaps").As<Napi::Object>();
-        remaps.clear();
+        activeConfig.remapNames.clear();
 
         // Convert each remap entry
         auto remapProps = remapsObj.GetPropertyNames();
@@ -364,7 +531,7 @@ Napi::Value KeyboardMonitor::SetConfig(const Napi::CallbackInfo& info) {
                 }
 
                 if (!targetKeys.empty()) {
-                    remaps[sourceKey] = targetKeys;
+                    activeConfig.remapNames[sourceKey] = targetKeys;
                 }
             }
         }
@@ -372,32 +539,439 @@ Napi::Value KeyboardMonitor::SetConfig(const Napi::CallbackInfo& info) {
 
     // Get maxRemapChainLength if present
     if (config.Has("maxRemapChainLength") && config.Get("maxRemapChainLength").IsNumber()) {
-        maxRemapChainLength = config.Get("maxRemapChainLength").As<Napi::Number>().Int32Value();
+        activeConfig.maxRemapChainLength = config.Get("maxRemapChainLength").As<Napi::Number>().Int32Value();
+        hasRemapChanges = true;
+    }
+
+    // Resolve names and reject circular chains once, so key events only index tables
+    if (hasRemapChanges) {
+        activeConfig.remaps = KeyMapping::CompileRemaps(activeConfig.remapNames, activeConfig.maxRemapChainLength);
     }
 
     // Get frameRate if present
     if (config.Has("frameRate") && config.Get("frameRate").IsNumber()) {
         int frameRate = config.Get("frameRate").As<Napi::Number>().Int32Value();
         if (frameRate > 0) {
-            FRAME_TIME_MICROS = 1000000 / frameRate;
+            activeConfig.frameTimeMicros = 1000000 / frameRate;
         }
     }
 
-    // Enable/disable remapper
-    if (config.Has("enableRemapper") && config.Get("enableRemapper").IsBoolean()) {
-        isRemapperEnabled = config.Get("enableRemapper").As<Napi::Boolean>().Value();
+    // Enable/disable remapper; enableRemapper is the older name for isRemapperEnabled
+    for (const char* key : {"isRemapperEnabled", "enableRemapper"}) {
+        if (config.Has(key) && config.Get(key).IsBoolean()) {
+            activeConfig.isRemapperEnabled = config.Get(key).As<Napi::Boolean>().Value();
+            break;
+        }
     }
 
     // Get gateTimeout if present
     if (config.Has("gateTimeout") && config.Get("gateTimeout").IsNumber()) {
-        gateTimeout = config.Get("gateTimeout").As<Napi::Number>().Int32Value();
+        activeConfig.gateTimeout = config.Get("gateTimeout").As<Napi::Number>().Int32Value();
+    }
+
+    // Enable/disable tracing
+    if (config.Has("tracing") && config.Get("tracing").IsBoolean()) {
+        activeConfig.isTracingEnabled = config.Get("tracing").As<Napi::Boolean>().Value();
+    }
+
+    // Get pipeline placement if present; applied on the next start
+    if (config.Has("pipeline") && config.Get("pipeline").IsObject()) {
+        Napi::Object pipelineObj = config.Get("pipeline").As<Napi::Object>();
+        auto readPlacement = [&pipelineObj](const char* stage, StagePlacement& placement) {
+            if (pipelineObj.Has(stage) && pipelineObj.Get(stage).IsString()) {
+                std::string value = pipelineObj.Get(stage).As<Napi::String>().Utf8Value();
+                placement = value == "worker" ? StagePlacement::Worker : StagePlacement::Capture;
+            }
+        };
+        readPlacement("frameBuilder", activeConfig.frameBuilderPlacement);
+        readPlacement("sinks", activeConfig.sinkPlacement);
+    }
+
+    // Get chords if present: [{ id, keys, trigger?, forbidden? }]
+    if (config.Has("chords") && config.Get("chords").IsArray()) {
+        Napi::Array chordsArray = config.Get("chords").As<Napi::Array>();
+        std::vector<ChordBinding> chords;
+        chords.reserve(chordsArray.Length());
+
+        auto readKeys = [](Napi::Value value, KeySnapshot& keys, DWORD& lastVK) {
+            if (!value.IsArray()) return false;
+            auto keyArray = value.As<Napi::Array>();
+            for (uint32_t j = 0; j < keyArray.Length(); j++) {
+                if (!keyArray.Get(j).IsString()) return false;
+                DWORD vkCode = KeyMapping::GetVirtualKeyCode(keyArray.Get(j).As<Napi::String>().Utf8Value());
+                if (vkCode == 0) return false;
+                keys.Set(vkCode);
+                lastVK = vkCode;
+            }
+            return true;
+        };
+
+        for (uint32_t i = 0; i < chordsArray.Length(); i++) {
+            if (!chordsArray.Get(i).IsObject()) continue;
+            Napi::Object chordObj = chordsArray.Get(i).As<Napi::Object>();
+            if (!chordObj.Has("id") || !chordObj.Get("id").IsNumber()) continue;
+
+            ChordBinding chord{};
+            chord.id = chordObj.Get("id").As<Napi::Number>().Uint32Value();
+
+            // A binding without keys would otherwise match its trigger alone
+            Napi::Value keysValue = chordObj.Get("keys");
+            if (!keysValue.IsArray() || keysValue.As<Napi::Array>().Length() == 0) {
+                printf("Warning: Chord %u needs a non-empty keys array\n", chord.id);
+                continue;
+            }
+
+            // The trigger defaults to the last listed key; forbidden is optional
+            DWORD triggerVK = 0;
+            DWORD ignoredVK = 0;
+            Napi::Value forbiddenValue = chordObj.Get("forbidden");
+            if (!readKeys(keysValue, chord.required, triggerVK) ||
+                (!forbiddenValue.IsUndefined() && !readKeys(forbiddenValue, chord.forbidden, ignoredVK))) {
+                printf("Warning: Chord %u references an unknown key\n", chord.id);
+                continue;
+            }
+            if (chordObj.Has("trigger") && chordObj.Get("trigger").IsString()) {
+                triggerVK = KeyMapping::GetVirtualKeyCode(
+                    chordObj.Get("trigger").As<Napi::String>().Utf8Value());
+            }
+            if (triggerVK == 0) continue;
+
+            chord.triggerVk = triggerVK;
+            chords.push_back(chord);
+        }
+
+        activeConfig.chords = std::move(chords);
+    }
+
+    // Get moves if present: [{ name, steps: [{ type, keys, minHoldMs, ... }] }]
+    if (config.Has("moves") && config.Get("moves").IsArray()) {
+        Napi::Array movesArray = config.Get("moves").As<Napi::Array>();
+        std::vector<MoveSpec> moves;
+        moves.reserve(movesArray.Length());
+
+        auto readMs = [](const Napi::Object& obj, const char* name) {
+            if (!obj.Has(name) || !obj.Get(name).IsNumber()) return 0;
+            return obj.Get(name).As<Napi::Number>().Int32Value();
+        };
+
+        for (uint32_t i = 0; i < movesArray.Length(); i++) {
+            if (!movesArray.Get(i).IsObject()) continue;
+            Napi::Object moveObj = movesArray.Get(i).As<Napi::Object>();
+            if (!moveObj.Get("name").IsString() || !moveObj.Get("steps").IsArray()) continue;
+
+            MoveSpec move;
+            move.name = moveObj.Get("name").As<Napi::String>().Utf8Value();
+            Napi::Array stepsArray = moveObj.Get("steps").As<Napi::Array>();
+
+            bool isValid = stepsArray.Length() > 0;
+            for (uint32_t j = 0; isValid && j < stepsArray.Length(); j++) {
+                if (!stepsArray.Get(j).IsObject()) {
+                    isValid = false;
+                    break;
+                }
+                Napi::Object stepObj = stepsArray.Get(j).As<Napi::Object>();
+
+                MoveStepSpec step;
+                std::string type = stepObj.Get("type").IsString()
+                    ? stepObj.Get("type").As<Napi::String>().Utf8Value() : "";
+                if (type == "press") {
+                    step.type = MoveStepType::Press;
+                } else if (type == "hold") {
+                    step.type = MoveStepType::Hold;
+                } else {
+                    printf("Warning: Move '%s' has unsupported step type '%s'\n", move.name.c_str(), type.c_str());
+                    isValid = false;
+                    break;
+                }
+
+                if (stepObj.Get("keys").IsArray()) {
+                    Napi::Array keyArray = stepObj.Get("keys").As<Napi::Array>();
+                    for (uint32_t k = 0; k < keyArray.Length(); k++) {
+                        DWORD vkCode = keyArray.Get(k).IsString()
+                            ? KeyMapping::GetVirtualKeyCode(keyArray.Get(k).As<Napi::String>().Utf8Value()) : 0;
+                        if (vkCode == 0) {
+                            printf("Warning: Move '%s' references an unknown key\n", move.name.c_str());
+                            isValid = false;
+                            break;
+                        }
+                        step.keys.Set(vkCode);
+                    }
+                }
+                if (!step.keys.Any()) isValid = false;
+
+                step.minHoldMs = readMs(stepObj, "minHoldMs");
+                step.maxHoldMs = readMs(stepObj, "maxHoldMs");
+                step.maxGapMs = readMs(stepObj, "maxGapMs");
+                step.multiPressToleranceMs = readMs(stepObj, "multiPressToleranceMs");
+                step.completeOnReleaseAfterMinHold = stepObj.Get("completeOnReleaseAfterMinHold").IsBoolean() &&
+                    stepObj.Get("completeOnReleaseAfterMinHold").As<Napi::Boolean>().Value();
+                move.steps.push_back(step);
+            }
+
+            if (isValid) moves.push_back(std::move(move));
+        }
+
+        activeConfig.moves = std::move(moves);
     }
 
+    // Get moveSpeculationWindowMs if present; a negative value follows the frame period
+    if (config.Has("moveSpeculationWindowMs") && config.Get("moveSpeculationWindowMs").IsNumber()) {
+        activeConfig.moveSpeculationWindowMs = config.Get("moveSpeculationWindowMs").As<Napi::Number>().Int32Value();
+    }
+
+    // Get holdThresholds if present: { [keyName]: number | number[] }
+    if (config.Has("holdThresholds") && config.Get("holdThresholds").IsObject()) {
+        Napi::Object thresholdsObj = config.Get("holdThresholds").As<Napi::Object>();
+        activeConfig.holdThresholds.clear();
+
+        auto thresholdProps = thresholdsObj.GetPropertyNames();
+        for (uint32_t i = 0; i < thresholdProps.Length(); i++) {
+            auto keyName = thresholdProps.Get(i).As<Napi::String>().Utf8Value();
+            DWORD vkCode = KeyMapping::GetVirtualKeyCode(keyName);
+            if (vkCode == 0) continue;
+
+            auto value = thresholdsObj.Get(keyName);
+            std::vector<uint32_t> thresholdsMs;
+            if (value.IsNumber()) {
+                int ms = value.As<Napi::Number>().Int32Value();
+                if (ms > 0) thresholdsMs.push_back(ms);
+            } else if (value.IsArray()) {
+                auto valueArray = value.As<Napi::Array>();
+                for (uint32_t j = 0; j < valueArray.Length(); j++) {
+                    if (valueArray.Get(j).IsNumber()) {
+                        int ms = valueArray.Get(j).As<Napi::Number>().Int32Value();
+                        if (ms > 0) thresholdsMs.push_back(ms);
+                    }
+                }
+            }
+
+            if (!thresholdsMs.empty()) {
+                activeConfig.holdThresholds.emplace_back(vkCode, std::move(thresholdsMs));
+            }
+        }
+    }
+
+    ApplyConfig();
     return env.Undefined();
 }
 
+void KeyboardMonitor::ApplyConfig() {
+    KeyMapping::SetCompiledRemaps(activeConfig.remaps);
+
+    FRAME_TIME_MICROS = activeConfig.frameTimeMicros;
+    gateTimeout = activeConfig.gateTimeout;
+    TraceRecorder::SetEnabled(activeConfig.isTracingEnabled);
+
+    long long nowMs = GetTimestampMs();
+    chordStage->SetChords(activeConfig.chords);
+    moveStage->SetMoves(activeConfig.moves, nowMs);
+    moveStage->SetSpeculationWindow(activeConfig.moveSpeculationWindowMs >= 0
+        ? activeConfig.moveSpeculationWindowMs
+        : activeConfig.frameTimeMicros / 1000);
+
+    std::lock_guard<std::mutex> lock(holdTimersMutex);
+    holdTimers.ClearThresholds();
+    for (const auto& [vkCode, thresholdsMs] : activeConfig.holdThresholds) {
+        holdTimers.SetThresholds(vkCode, thresholdsMs, nowMs);
+    }
+}
+
+Napi::Value KeyboardMonitor::SaveCompiledConfig(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "File path and config hash expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::wstring path = ToWidePath(info[0].As<Napi::String>().Utf8Value());
+    std::string configHash = info[1].As<Napi::String>().Utf8Value();
+
+    std::vector<uint8_t> image;
+    CompiledConfigImage::Write(activeConfig, configHash, image);
+
+    // Write beside the target and swap it in, so a reader never maps a partial image
+    std::wstring tempPath = path + L".tmp";
+    HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    DWORD written = 0;
+    bool isWritten = WriteFile(file, image.data(), static_cast<DWORD>(image.size()), &written, NULL) &&
+                     written == image.size();
+    CloseHandle(file);
+
+    if (!isWritten || !MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(tempPath.c_str());
+        return Napi::Boolean::New(env, false);
+    }
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value KeyboardMonitor::LoadCompiledConfig(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "File path and config hash expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::wstring path = ToWidePath(info[0].As<Napi::String>().Utf8Value());
+    std::string configHash = info[1].As<Napi::String>().Utf8Value();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // Decode straight out of the mapped view into activeConfig's containers;
+    // a stale or damaged image is rejected and the caller falls back to setConfig
+    CompiledConfig loaded;
+    bool isLoaded = false;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view) {
+                isLoaded = CompiledConfigImage::Read(static_cast<const uint8_t*>(view),
+                    static_cast<size_t>(size.QuadPart), configHash, loaded);
+                UnmapViewOfFile(view);
+            }
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+
+    if (isLoaded) {
+        activeConfig = std::move(loaded);
+        ApplyConfig();
+    }
+    return Napi::Boolean::New(env, isLoaded);
+}
+
+std::wstring KeyboardMonitor::ToWidePath(const std::string& path) {
+    int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, NULL, 0);
+    if (length <= 0) return std::wstring();
+
+    std::wstring widePath(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+    widePath.resize(length - 1);
+    return widePath;
+}
+
+Napi::Value KeyboardMonitor::GetHoldDuration(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Key name expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    DWORD vkCode = KeyMapping::GetVirtualKeyCode(info[0].As<Napi::String>().Utf8Value());
+    long long heldMs = holdTimers.GetHoldDuration(vkCode, GetTimestampMs());
+
+    // -1 when the key is unknown or not held
+    return Napi::Number::New(env, static_cast<double>(heldMs));
+}
+
+Napi::Value KeyboardMonitor::GetPipelineStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Array stats = Napi::Array::New(env);
+    uint32_t index = 0;
+
+    auto addStage = [&](const char* name, StagePlacement placement, const StageCounters& counters) {
+        Napi::Object stageObj = Napi::Object::New(env);
+        stageObj.Set("stage", Napi::String::New(env, name));
+        stageObj.Set("placement", Napi::String::New(env,
+            placement == StagePlacement::Worker ? "worker" : "capture"));
+        stageObj.Set("processed", Napi::Number::New(env,
+            static_cast<double>(counters.processed.load(std::memory_order_relaxed))));
+        stageObj.Set("dropped", Napi::Number::New(env,
+            static_cast<double>(counters.dropped.load(std::memory_order_relaxed))));
+        stats.Set(index++, stageObj);
+    };
+
+    addStage("source", StagePlacement::Capture, sourceCounters);
+    for (const auto& stage : inputStages) {
+        addStage(stage->Name(), StagePlacement::Capture, stage->counters);
+    }
+    addStage("eventQueue", frameBuilderPlacement, eventQueue.counters);
+    addStage("frameBuilder", frameBuilderPlacement, frameBuilderCounters);
+    addStage("frameQueue", sinkPlacement, frameQueue.counters);
+    for (const auto& sink : frameSinks) {
+        addStage(sink->Name(), sinkPlacement, sink->counters);
+    }
+
+    return stats;
+}
+
+Napi::Value KeyboardMonitor::WriteTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "File path expected").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    return Napi::Boolean::New(env, TraceRecorder::WriteChromeTrace(path));
+}
+
+bool KeyboardMonitor::UsesWorker() const {
+    return frameBuilderPlacement == StagePlacement::Worker ||
+           sinkPlacement == StagePlacement::Worker;
+}
+
+void KeyboardMonitor::StartWorker() {
+    if (isWorkerRunning) return;
+
+    if (!workerWakeEvent) {
+        workerWakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    }
+    isWorkerRunning = true;
+    workerThread = CreateThread(NULL, 0, PipelineWorkerProc, this, 0, NULL);
+    if (!workerThread) {
+        // Fall back to running everything on the capture thread
+        isWorkerRunning = false;
+        frameBuilderPlacement = StagePlacement::Capture;
+        sinkPlacement = StagePlacement::Capture;
+    }
+}
+
+void KeyboardMonitor::StopWorker() {
+    if (!isWorkerRunning) return;
+
+    isWorkerRunning = false;
+    WakeWorker();
+    WaitForSingleObject(workerThread, INFINITE);
+    CloseHandle(workerThread);
+    workerThread = NULL;
+}
+
+void KeyboardMonitor::WakeWorker() {
+    if (workerWakeEvent) {
+        SetEvent(workerWakeEvent);
+    }
+}
+
+void KeyboardMonitor::DrainWorkerQueues() {
+    TRACE_SCOPE("DrainWorkerQueues");
+    PipelineMessage message;
+    while (eventQueue.TryPop(message)) {
+        HandlePipelineMessage(message);
+    }
+
+    KeyboardFrame frame;
+    while (frameQueue.TryPop(frame)) {
+        RunFrameSinks(frame);
+    }
+}
+
 DWORD WINAPI PollingThreadProc(LPVOID param) {
     KeyboardMonitor* monitor = (KeyboardMonitor*)param;
+    TraceRecorder::SetThreadName("capture");
     while (monitor->isPolling) {
         monitor->PollKeyboardState();
         Sleep(KeyboardMonitor::POLLING_INTERVAL);
@@ -405,6 +979,18 @@ DWORD WINAPI PollingThreadProc(LPVOID param) {
     return 0;
 }
 
+DWORD WINAPI PipelineWorkerProc(LPVOID param) {
+    KeyboardMonitor* monitor = (KeyboardMonitor*)param;
+    TraceRecorder::SetThreadName("pipeline-worker");
+    while (monitor->isWorkerRunning) {
+        WaitForSingleObject(monitor->workerWakeEvent, KeyboardMonitor::WORKER_IDLE_TIMEOUT);
+        monitor->DrainWorkerQueues();
+    }
+    // Deliver whatever the capture thread queued before it stopped
+    monitor->DrainWorkerQueues();
+    return 0;
+}
+
 void KeyboardMonitor::OpenGate() {
     isGateOpen = true;
     lastKeyEventTime = std::chrono::steady_clock::now();
@@ -3,21 +3,30 @@
 #include <napi.h>
 #include <windows.h>
 #include <set>
-#include <queue>
 #include <map>
 #include <chrono>
 #include <string>
 #include <vector>
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "compiled_config.h"
+#include "hold_timers.h"
+#include "input_pipeline.h"
+#include "key_snapshot.h"
+#include "move_recognizer.h"
 
-// Forward declare the polling thread function
+// Forward declare the thread functions
 DWORD WINAPI PollingThreadProc(LPVOID param);
+DWORD WINAPI PipelineWorkerProc(LPVOID param);
 
 struct KeyboardFrame {
-    std::set<DWORD> justPressed;
-    std::set<DWORD> held;
-    std::set<DWORD> justReleased;
-    std::map<DWORD, int> holdDurations;
+    KeySnapshot justPressed;
+    KeySnapshot held;
+    KeySnapshot justReleased;
+    // Frames held per key; only valid for keys in held, filled in when the frame is delivered
+    std::array<int, KeySnapshot::KEY_COUNT> holdDurations;
     long long timestamp;
     int frameNumber;
     struct {
@@ -27,6 +36,24 @@ struct KeyboardFrame {
     bool gateOpen;
 };
 
+class ChordStage;
+class MoveStage;
+
+// Work handed from the capture thread to the frame builder
+struct PipelineMessage {
+    enum class Kind : uint8_t {
+        BeginTick,  // start of a poll: advance gate and frame timing
+        Event,      // a key transition that survived the input stages
+        EndTick     // end of a poll: expire hold timers, deliver a due frame
+    };
+
+    Kind kind;
+    KeyInputEvent event;
+    // EndTick: every key the source has dispatched as held. The worker
+    // queue drops pushes when full, so the builder resyncs against this.
+    KeySnapshot heldKeys{};
+};
+
 class KeyboardMonitor : public Napi::ObjectWrap<KeyboardMonitor> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -38,20 +65,22 @@ private:
     int FRAME_TIME_MICROS = 16667;  // Default to 60 FPS (1/60th second in microseconds)
     static const int BUFFER_SIZE = 60;
     static const int POLLING_INTERVAL = 1;
+    static const int EVENT_QUEUE_SIZE = 1024;
+    static const int FRAME_QUEUE_SIZE = 64;
+    static const int WORKER_IDLE_TIMEOUT = 100;
 
     // Thread-safe function for callbacks
     Napi::ThreadSafeFunction tsfn;
 
     // State
     bool isEnabled = false;
-    bool isRemapperEnabled = false;
     bool isPolling = false;
     HANDLE pollingThread = NULL;
     
     // Configuration
-    std::map<std::string, std::vector<std::string>> remaps;
-    int maxRemapChainLength = 5;
     int gateTimeout = 1000; // Default 1000ms timeout
+    // Everything SetConfig has resolved so far; applied as a whole and cached to disk
+    CompiledConfig activeConfig;
     
     // Frame management
     std::array<KeyboardFrame, BUFFER_SIZE> frameBuffer;
@@ -60,7 +89,36 @@ private:
     std::chrono::steady_clock::time_point lastFrameTime;
     std::chrono::steady_clock::time_point lastPollTime;
     std::chrono::steady_clock::time_point lastKeyEventTime;
-    std::map<DWORD, int> keyPressStartFrames;
+    std::array<int, KeySnapshot::KEY_COUNT> keyPressStartFrames{};
+    bool isFrameDue = false;
+
+    // VKs worth polling: named keys minus mouse, media and IME codes
+    KeySnapshot captureMask;
+    // Keys the source has already reported as pressed (capture thread only)
+    KeySnapshot reportedKeys;
+    // Keys whose last Event sent to the frame builder was a press (capture thread only)
+    KeySnapshot dispatchedKeys;
+
+    // Pipeline: source -> input stages -> frame builder -> sinks
+    StageCounters sourceCounters;
+    StageCounters frameBuilderCounters;
+    std::vector<std::unique_ptr<InputStage>> inputStages;
+    ChordStage* chordStage = nullptr;  // owned by inputStages
+    MoveStage* moveStage = nullptr;    // owned by inputStages
+    std::vector<std::unique_ptr<FrameSink<KeyboardFrame>>> frameSinks;
+    StagePlacement frameBuilderPlacement = StagePlacement::Capture;
+    StagePlacement sinkPlacement = StagePlacement::Capture;
+    BoundedQueue<PipelineMessage, EVENT_QUEUE_SIZE> eventQueue;
+    BoundedQueue<KeyboardFrame, FRAME_QUEUE_SIZE> frameQueue;
+    std::atomic<bool> isWorkerRunning{false};
+    HANDLE workerThread = NULL;
+    HANDLE workerWakeEvent = NULL;
+
+    // Hold thresholds; guarded because SetConfig runs on the JS thread
+    HoldTimerQueue holdTimers;
+    std::mutex holdTimersMutex;
+    // Filled under holdTimersMutex, emitted after it is released (frame builder only)
+    std::vector<HoldReached> expiredHolds;
 
     // Gate state
     bool isGateOpen = false;
@@ -69,14 +127,56 @@ private:
     Napi::Value Start(const Napi::CallbackInfo& info);
     Napi::Value Stop(const Napi::CallbackInfo& info);
     Napi::Value SetConfig(const Napi::CallbackInfo& info);
+    Napi::Value GetHoldDuration(const Napi::CallbackInfo& info);
+    Napi::Value GetPipelineStats(const Napi::CallbackInfo& info);
+    Napi::Value WriteTrace(const Napi::CallbackInfo& info);
+    Napi::Value SaveCompiledConfig(const Napi::CallbackInfo& info);
+    Napi::Value LoadCompiledConfig(const Napi::CallbackInfo& info);
+
+    // Config (JS thread)
+    void ApplyConfig();
+    static std::wstring ToWidePath(const std::string& path);
     
+    // Source (capture thread)
     void PollKeyboardState();
+    void CaptureKeySnapshot(KeySnapshot& snapshot) const;
+    bool RunInputStages(KeyInputEvent& event);
+    void DispatchKeyEvent(const KeyInputEvent& event);
+    void DispatchToFrameBuilder(const PipelineMessage& message);
+
+    // Frame builder (capture thread or worker)
+    void HandlePipelineMessage(const PipelineMessage& message);
+    void BeginFrameTick();
+    void ApplyKeyEvent(const KeyInputEvent& event);
+    void ResyncFrameHeld(const KeySnapshot& heldKeys, long long nowMs);
+    void EndFrameTick(long long nowMs);
+    void DeliverFrame(const KeyboardFrame& frame);
     void CreateNewFrame();
+
+    // Sinks (same thread as the frame builder, or worker)
+    void RunFrameSinks(const KeyboardFrame& frame);
     void EmitFrame(const KeyboardFrame& frame);
-    void ProcessKeyEvent(DWORD vkCode, bool isKeyDown);
+    void EmitHoldReached(const HoldReached& reached);
+    void EmitChord(uint32_t chordId, DWORD vkCode);
+    void EmitMove(const std::string& name, MovePhase phase, long long timestampMs);
+    void TrackHoldPress(DWORD vkCode, long long nowMs);
+    void TrackHoldRelease(DWORD vkCode);
+    void ExpireHoldTimers(long long nowMs);
     int GetFramesSince(int startFrame) const;
     void UpdateGateState();
     void OpenGate();
+    static long long GetTimestampMs();
+
+    // Worker thread
+    bool UsesWorker() const;
+    void StartWorker();
+    void StopWorker();
+    void WakeWorker();
+    void DrainWorkerQueues();
 
     friend DWORD WINAPI PollingThreadProc(LPVOID param);
+    friend DWORD WINAPI PipelineWorkerProc(LPVOID param);
+    friend class JsEmitSink;
+    friend class ChordStage;
+    friend class MoveStage;
 }; 
\ No newline at end of file
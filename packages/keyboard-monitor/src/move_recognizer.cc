@@ -0,0 +1,185 @@
+#include "move_recognizer.h"
+#include <algorithm>
+
+MoveRecognizer::MoveRecognizer() {
+    Clear();
+}
+
+void MoveRecognizer::Build(std::vector<MoveSpec> specs) {
+    // Moves without steps can never complete
+    specs.erase(std::remove_if(specs.begin(), specs.end(), [](const MoveSpec& move) {
+        return move.steps.empty();
+    }), specs.end());
+
+    moves = std::move(specs);
+    progress.assign(moves.size(), Progress());
+
+    // Each move queues at most a confirm, a cancel and a start per call, and
+    // the queue is drained after every call, so this never grows at runtime
+    signals.clear();
+    signals.reserve(moves.size() * 3);
+}
+
+void MoveRecognizer::CancelPending(long long nowMs) {
+    for (uint32_t id = 0; id < moves.size(); id++) {
+        Progress& state = progress[id];
+        if (!state.isPending) continue;
+
+        state.isPending = false;
+        signals.push_back(MoveSignal{id, MovePhase::Cancelled, nowMs});
+    }
+}
+
+void MoveRecognizer::SetSpeculationWindow(int windowMs) {
+    speculationWindowMs = std::max(windowMs, 0);
+}
+
+void MoveRecognizer::Clear() {
+    moves.clear();
+    progress.clear();
+    signals.clear();
+    held.Clear();
+    lastPressMs.fill(-1);
+}
+
+void MoveRecognizer::OnKey(uint32_t vkCode, bool isKeyDown, long long nowMs) {
+    if (vkCode >= KEY_COUNT) return;
+
+    if (isKeyDown) {
+        // Auto-repeat is not a new transition
+        if (held.Test(vkCode)) return;
+        held.Set(vkCode);
+        lastPressMs[vkCode] = nowMs;
+
+        SettleWindows(nowMs, vkCode);
+        for (uint32_t id = 0; id < moves.size(); id++) {
+            Progress& state = progress[id];
+            if (HasTimedOut(moves[id].steps[state.stepIndex], state, nowMs)) {
+                state.stepIndex = 0;
+                state.stepStartMs = -1;
+            }
+
+            const MoveStepSpec& step = moves[id].steps[state.stepIndex];
+            if (!step.keys.Test(vkCode)) continue;
+
+            bool isDone = step.type == MoveStepType::Press
+                ? IsPressStepDone(step, state)
+                : !step.completeOnReleaseAfterMinHold && IsHoldStepDone(step, state, nowMs);
+            if (isDone) CompleteStep(id, nowMs);
+        }
+        return;
+    }
+
+    if (!held.Test(vkCode)) return;
+
+    SettleWindows(nowMs, KEY_COUNT);
+    for (uint32_t id = 0; id < moves.size(); id++) {
+        Progress& state = progress[id];
+        if (HasTimedOut(moves[id].steps[state.stepIndex], state, nowMs)) {
+            state.stepIndex = 0;
+            state.stepStartMs = -1;
+        }
+
+        // Release steps are checked while the key still counts as held
+        const MoveStepSpec& step = moves[id].steps[state.stepIndex];
+        if (step.type == MoveStepType::Hold && step.completeOnReleaseAfterMinHold &&
+            step.keys.Test(vkCode) && IsHoldStepDone(step, state, nowMs)) {
+            CompleteStep(id, nowMs);
+        }
+    }
+    held.Reset(vkCode);
+}
+
+void MoveRecognizer::Advance(long long nowMs) {
+    SettleWindows(nowMs, KEY_COUNT);
+
+    for (uint32_t id = 0; id < moves.size(); id++) {
+        Progress& state = progress[id];
+        if (HasTimedOut(moves[id].steps[state.stepIndex], state, nowMs)) {
+            state.stepIndex = 0;
+            state.stepStartMs = -1;
+        }
+
+        // Plain hold steps complete on time alone, without a transition
+        const MoveStepSpec& step = moves[id].steps[state.stepIndex];
+        if (step.type == MoveStepType::Hold && !step.completeOnReleaseAfterMinHold &&
+            IsHoldStepDone(step, state, nowMs)) {
+            CompleteStep(id, nowMs);
+        }
+    }
+}
+
+void MoveRecognizer::SettleWindows(long long nowMs, uint32_t pressedVk) {
+    for (uint32_t id = 0; id < moves.size(); id++) {
+        Progress& state = progress[id];
+        if (!state.isPending) continue;
+
+        if (nowMs >= state.windowEndMs) {
+            state.isPending = false;
+            signals.push_back(MoveSignal{id, MovePhase::Confirmed, nowMs});
+        } else if (pressedVk < KEY_COUNT && !moves[id].steps.back().keys.Test(pressedVk)) {
+            state.isPending = false;
+            signals.push_back(MoveSignal{id, MovePhase::Cancelled, nowMs});
+        }
+    }
+}
+
+bool MoveRecognizer::IsPressStepDone(const MoveStepSpec& step, const Progress& state) const {
+    // Without an explicit tolerance, keys must land in the same window, the
+    // way the sequence manager merges one frame of presses
+    int toleranceMs = step.multiPressToleranceMs > 0 ? step.multiPressToleranceMs : speculationWindowMs;
+
+    long long earliest = -1;
+    long long latest = -1;
+    bool isMissing = false;
+    ForEachKey(step.keys, [&](uint32_t vk) {
+        long long pressMs = lastPressMs[vk];
+        if (pressMs < 0 || pressMs < state.stepStartMs) {
+            isMissing = true;
+            return;
+        }
+        if (earliest < 0 || pressMs < earliest) earliest = pressMs;
+        if (pressMs > latest) latest = pressMs;
+    });
+
+    return !isMissing && latest - earliest <= toleranceMs;
+}
+
+bool MoveRecognizer::IsHoldStepDone(const MoveStepSpec& step, const Progress& state, long long nowMs) const {
+    if (!step.keys.IsSubsetOf(held)) return false;
+
+    // The shortest hold among the keys counts; it must have begun after the
+    // move last finished, so one long hold doesn't fire the move every tick
+    long long latestPress = -1;
+    ForEachKey(step.keys, [&](uint32_t vk) {
+        latestPress = std::max(latestPress, lastPressMs[vk]);
+    });
+    if (latestPress <= state.lastFinishMs) return false;
+
+    long long heldMs = nowMs - latestPress;
+    if (heldMs < step.minHoldMs) return false;
+    return step.maxHoldMs <= 0 || heldMs <= step.maxHoldMs;
+}
+
+bool MoveRecognizer::HasTimedOut(const MoveStepSpec& step, const Progress& state, long long nowMs) const {
+    return state.stepIndex > 0 && step.maxGapMs > 0 && nowMs - state.stepStartMs > step.maxGapMs;
+}
+
+void MoveRecognizer::CompleteStep(uint32_t moveId, long long nowMs) {
+    Progress& state = progress[moveId];
+    state.stepIndex++;
+    state.stepStartMs = nowMs;
+    if (state.stepIndex < moves[moveId].steps.size()) return;
+
+    state.stepIndex = 0;
+    state.stepStartMs = -1;
+    state.lastFinishMs = nowMs;
+
+    // A repeat inside the window confirms the earlier instance first
+    if (state.isPending) {
+        signals.push_back(MoveSignal{moveId, MovePhase::Confirmed, nowMs});
+    }
+    signals.push_back(MoveSignal{moveId, MovePhase::Started, nowMs});
+    state.isPending = true;
+    state.windowEndMs = nowMs + speculationWindowMs;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "key_snapshot.h"
+
+enum class MoveStepType : uint8_t {
+    Press,
+    Hold
+};
+
+// Mirrors the sequence manager's MoveStep. Zero means "no limit" for the
+// optional timings.
+struct MoveStepSpec {
+    MoveStepType type = MoveStepType::Press;
+    KeySnapshot keys;
+    int minHoldMs = 0;
+    int maxHoldMs = 0;
+    int maxGapMs = 0;
+    int multiPressToleranceMs = 0;
+    bool completeOnReleaseAfterMinHold = false;
+};
+
+struct MoveSpec {
+    std::string name;
+    std::vector<MoveStepSpec> steps;
+};
+
+enum class MovePhase : uint8_t {
+    Started,    // final transition seen; provisional
+    Confirmed,  // speculation window closed without conflicting input
+    Cancelled   // conflicting input arrived inside the window
+};
+
+struct MoveSignal {
+    uint32_t moveId;  // index into the built moves
+    MovePhase phase;
+    long long timestampMs;
+};
+
+// Recognizes move sequences on raw key transitions instead of frames.
+//
+// A move is reported as Started the moment the transition that completes its
+// last step arrives. It stays provisional for speculationWindowMs; a press of
+// any key outside the final step in that window means the input was really a
+// larger chord, so the move is rolled back with Cancelled. Otherwise it is
+// Confirmed when the window closes.
+//
+// Steps follow the sequence manager's checkPressStep and checkHoldStep, with
+// a few deliberate differences:
+//  - Press: keys must land within multiPressToleranceMs of each other, or
+//    within speculationWindowMs when that is unset, and after the step began.
+//    The frame path instead needs every key inside the last ~16.67ms frame,
+//    even when the tolerance is larger.
+//  - Hold: measured from the latest press among the keys, like holdDuration,
+//    but not capped by the frame path's 2s input buffer. The hold must start
+//    after the move last finished, so one long hold fires it once rather than
+//    every frame.
+//  - Release-completed holds are judged at the release transition; the frame
+//    path only sees the key after it is gone, with no hold duration left.
+//
+// Not thread-safe; all calls must come from the same thread or be serialized.
+class MoveRecognizer {
+public:
+    MoveRecognizer();
+
+    // Queued signals index the old moves, so call CancelPending and drain
+    // before rebuilding; anything still queued is discarded.
+    void Build(std::vector<MoveSpec> specs);
+    void SetSpeculationWindow(int windowMs);
+
+    // Rolls back every provisional move with Cancelled
+    void CancelPending(long long nowMs);
+    void Clear();
+
+    size_t Size() const { return moves.size(); }
+    const MoveSpec& GetMove(uint32_t moveId) const { return moves[moveId]; }
+
+    void OnKey(uint32_t vkCode, bool isKeyDown, long long nowMs);
+
+    // Closes expired windows, completes hold steps and drops timed-out progress
+    void Advance(long long nowMs);
+
+    // Hands every queued signal to cb(const MoveSignal&) in order
+    template <typename Callback>
+    void Drain(Callback&& cb) {
+        for (const MoveSignal& signal : signals) cb(signal);
+        signals.clear();
+    }
+
+private:
+    static const int KEY_COUNT = KeySnapshot::KEY_COUNT;
+
+    struct Progress {
+        size_t stepIndex = 0;
+        long long stepStartMs = -1;  // -1 while waiting for the first step
+        long long lastFinishMs = -1;
+        bool isPending = false;
+        long long windowEndMs = 0;
+    };
+
+    std::vector<MoveSpec> moves;
+    std::vector<Progress> progress;
+    std::vector<MoveSignal> signals;
+    KeySnapshot held;
+    std::array<long long, KEY_COUNT> lastPressMs;
+    int speculationWindowMs = 16;
+
+    void SettleWindows(long long nowMs, uint32_t pressedVk);
+    bool IsPressStepDone(const MoveStepSpec& step, const Progress& state) const;
+    bool IsHoldStepDone(const MoveStepSpec& step, const Progress& state, long long nowMs) const;
+    bool HasTimedOut(const MoveStepSpec& step, const Progress& state, long long nowMs) const;
+    void CompleteStep(uint32_t moveId, long long nowMs);
+};
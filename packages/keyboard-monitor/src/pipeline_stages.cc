@@ -0,0 +1,72 @@
+#include "pipeline_stages.h"
+#include "keyboard_monitor.h"
+#include "trace_events.h"
+
+void ChordStage::SetChords(std::vector<ChordBinding> chords) {
+    std::lock_guard<std::mutex> lock(matcherMutex);
+    matcher.Build(std::move(chords));
+}
+
+bool ChordStage::Process(KeyInputEvent& event) {
+    if (!event.isKeyDown) {
+        held.Reset(event.vkCode);
+        return true;
+    }
+
+    // Auto-repeat doesn't re-trigger a chord
+    if (held.Test(event.vkCode)) return true;
+    held.Set(event.vkCode);
+
+    std::lock_guard<std::mutex> lock(matcherMutex);
+    if (matcher.Size() == 0) return true;
+
+    TRACE_SCOPE("MatchChords");
+    matcher.Match(event.vkCode, held, [this, &event](uint32_t id) {
+        monitor.EmitChord(id, event.vkCode);
+    });
+    return true;
+}
+
+void MoveStage::SetMoves(std::vector<MoveSpec> moves, long long nowMs) {
+    std::lock_guard<std::mutex> lock(recognizerMutex);
+    recognizer.CancelPending(nowMs);
+    EmitSignals();
+    recognizer.Build(std::move(moves));
+}
+
+void MoveStage::SetSpeculationWindow(int windowMs) {
+    std::lock_guard<std::mutex> lock(recognizerMutex);
+    recognizer.SetSpeculationWindow(windowMs);
+}
+
+void MoveStage::Advance(long long nowMs) {
+    std::lock_guard<std::mutex> lock(recognizerMutex);
+    if (recognizer.Size() == 0) return;
+
+    recognizer.Advance(nowMs);
+    EmitSignals();
+}
+
+bool MoveStage::Process(KeyInputEvent& event) {
+    std::lock_guard<std::mutex> lock(recognizerMutex);
+    if (recognizer.Size() == 0) return true;
+
+    TRACE_SCOPE("RecognizeMoves");
+    recognizer.OnKey(event.vkCode, event.isKeyDown, event.timestampMs);
+    EmitSignals();
+    return true;
+}
+
+void MoveStage::EmitSignals() {
+    recognizer.Drain([this](const MoveSignal& signal) {
+        monitor.EmitMove(recognizer.GetMove(signal.moveId).name, signal.phase, signal.timestampMs);
+    });
+}
+
+bool KeyFilterStage::Process(KeyInputEvent& event) {
+    return captureMask.Test(event.vkCode);
+}
+
+void JsEmitSink::Consume(const KeyboardFrame& frame) {
+    monitor.EmitFrame(frame);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <windows.h>
+#include <mutex>
+#include <vector>
+#include "chord_matcher.h"
+#include "input_pipeline.h"
+#include "key_snapshot.h"
+#include "move_recognizer.h"
+
+struct KeyboardFrame;
+class KeyboardMonitor;
+
+// Matches chord bindings against physical key state and fires their IDs from
+// the capture thread. Runs ahead of the filter so chords see every physical
+// key. Never drops events.
+class ChordStage : public InputStage {
+public:
+    explicit ChordStage(KeyboardMonitor& monitor) : monitor(monitor) {}
+    const char* Name() const override { return "chords"; }
+
+    // Replaces all bindings (JS thread)
+    void SetChords(std::vector<ChordBinding> chords);
+
+protected:
+    bool Process(KeyInputEvent& event) override;
+
+private:
+    KeyboardMonitor& monitor;
+    KeySnapshot held;
+    ChordMatcher matcher;
+    std::mutex matcherMutex;
+};
+
+// Recognizes moves on raw transitions so they fire before the frame that
+// carries them is built. Runs after chords, ahead of the filter, and
+// never drops events.
+class MoveStage : public InputStage {
+public:
+    explicit MoveStage(KeyboardMonitor& monitor) : monitor(monitor) {}
+    const char* Name() const override { return "moves"; }
+
+    // Replaces all moves (JS thread)
+    // Moves still inside their speculation window are cancelled first
+    void SetMoves(std::vector<MoveSpec> moves, long long nowMs);
+    void SetSpeculationWindow(int windowMs);
+
+    // Called once per poll on the capture thread, before that poll's events
+    void Advance(long long nowMs);
+
+protected:
+    bool Process(KeyInputEvent& event) override;
+
+private:
+    KeyboardMonitor& monitor;
+    MoveRecognizer recognizer;
+    std::mutex recognizerMutex;
+
+    void EmitSignals();
+};
+
+// Drops keys that are never reported: unnamed, mouse, media and IME codes.
+class KeyFilterStage : public InputStage {
+public:
+    explicit KeyFilterStage(const KeySnapshot& captureMask) : captureMask(captureMask) {}
+    const char* Name() const override { return "filter"; }
+
+protected:
+    bool Process(KeyInputEvent& event) override;
+
+private:
+    const KeySnapshot& captureMask;
+};
+
+// Converts frames to JS objects and hands them to the thread-safe function
+class JsEmitSink : public FrameSink<KeyboardFrame> {
+public:
+    explicit JsEmitSink(KeyboardMonitor& monitor) : monitor(monitor) {}
+    const char* Name() const override { return "emit"; }
+
+protected:
+    void Consume(const KeyboardFrame& frame) override;
+
+private:
+    KeyboardMonitor& monitor;
+};
@@ -0,0 +1,181 @@
+#include "trace_events.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> TraceRecorder::enabled{false};
+std::atomic<uint32_t> TraceRecorder::generation{0};
+
+namespace {
+    struct TraceEvent {
+        const char* name;
+        long long timestampUs;
+        long long durationUs;
+        char phase;  // 'X' complete span, 'i' instant
+    };
+
+    struct ThreadBuffer {
+        uint32_t threadId = 0;
+        std::atomic<const char*> threadName{nullptr};
+        std::atomic<bool> inUse{true};
+        std::atomic<uint64_t> count{0};
+        // Recorder generation the events belong to; a stale one means cleared
+        std::atomic<uint32_t> generation{0};
+        std::array<TraceEvent, TraceRecorder::EVENTS_PER_THREAD> events;
+    };
+
+    // Buffers are never freed: a thread that exits marks its buffer retired so
+    // a later thread can reuse it, which keeps memory bounded across repeated
+    // start/stop cycles. Retired buffers still holding current events are only
+    // taken once the registry is full, so an exited thread's events normally
+    // survive until the next clear.
+    const size_t MAX_THREAD_BUFFERS = 16;
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> registry;
+    uint32_t nextThreadId = 1;
+
+    struct ThreadBufferHandle {
+        ThreadBuffer* buffer = nullptr;
+        const char* pendingName = nullptr;
+
+        ~ThreadBufferHandle() {
+            if (buffer) buffer->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadBufferHandle localBuffer;
+
+    ThreadBuffer* GetThreadBuffer(uint32_t generation) {
+        if (localBuffer.buffer) return localBuffer.buffer;
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ThreadBuffer* buffer = nullptr;
+        ThreadBuffer* retiredWithEvents = nullptr;
+        for (auto& candidate : registry) {
+            if (candidate->inUse.load(std::memory_order_acquire)) continue;
+            if (candidate->generation.load(std::memory_order_relaxed) != generation ||
+                candidate->count.load(std::memory_order_relaxed) == 0) {
+                buffer = candidate.get();
+                break;
+            }
+            if (!retiredWithEvents) retiredWithEvents = candidate.get();
+        }
+        if (!buffer && registry.size() >= MAX_THREAD_BUFFERS) {
+            buffer = retiredWithEvents;
+        }
+        if (!buffer) {
+            registry.push_back(std::make_unique<ThreadBuffer>());
+            buffer = registry.back().get();
+        }
+
+        buffer->threadId = nextThreadId++;
+        buffer->threadName.store(localBuffer.pendingName, std::memory_order_relaxed);
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->generation.store(generation, std::memory_order_relaxed);
+        buffer->inUse.store(true, std::memory_order_release);
+        localBuffer.buffer = buffer;
+        return buffer;
+    }
+
+    void Append(const TraceEvent& event, uint32_t generation) {
+        ThreadBuffer* buffer = GetThreadBuffer(generation);
+
+        // Clearing is applied here by the owner, so count has a single writer
+        if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->generation.store(generation, std::memory_order_release);
+        }
+
+        uint64_t index = buffer->count.load(std::memory_order_relaxed);
+        buffer->events[index % TraceRecorder::EVENTS_PER_THREAD] = event;
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+}
+
+void TraceRecorder::SetEnabled(bool isEnabled) {
+    if (isEnabled && !enabled.load(std::memory_order_relaxed)) {
+        generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    enabled.store(isEnabled, std::memory_order_release);
+}
+
+void TraceRecorder::SetThreadName(const char* name) {
+    localBuffer.pendingName = name;
+    if (localBuffer.buffer) {
+        localBuffer.buffer->threadName.store(name, std::memory_order_relaxed);
+    }
+}
+
+void TraceRecorder::RecordSpan(const char* name, long long startUs, long long endUs) {
+    Append(TraceEvent{name, startUs, endUs - startUs, 'X'}, generation.load(std::memory_order_acquire));
+}
+
+void TraceRecorder::RecordInstant(const char* name) {
+    Append(TraceEvent{name, NowMicros(), 0, 'i'}, generation.load(std::memory_order_acquire));
+}
+
+bool TraceRecorder::WriteChromeTrace(const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) return false;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first) out << ",\n";
+        first = false;
+    };
+
+    uint32_t currentGeneration = generation.load(std::memory_order_acquire);
+    std::vector<TraceEvent> events;
+    events.reserve(EVENTS_PER_THREAD);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        if (buffer->generation.load(std::memory_order_acquire) != currentGeneration) continue;
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0) continue;
+
+        // Only the newest EVENTS_PER_THREAD events survive in the ring
+        uint64_t start = count > EVENTS_PER_THREAD ? count - EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint64_t i = start; i < count; i++) {
+            events.push_back(buffer->events[i % EVENTS_PER_THREAD]);
+        }
+
+        // The owner kept appending while we copied. Anything at or below
+        // newCount - EVENTS_PER_THREAD may have been overwritten (the slot at
+        // newCount is the one being written now), so drop it; a reset since
+        // the first read invalidates the whole copy.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newCount = buffer->count.load(std::memory_order_relaxed);
+        if (buffer->generation.load(std::memory_order_relaxed) != currentGeneration || newCount < count) continue;
+        uint64_t firstValid = newCount >= EVENTS_PER_THREAD ? newCount - EVENTS_PER_THREAD + 1 : 0;
+        size_t skipped = firstValid > start ? static_cast<size_t>(std::min(firstValid - start, count - start)) : 0;
+
+        const char* threadName = buffer->threadName.load(std::memory_order_relaxed);
+        if (threadName) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"args\":{\"name\":\"" << threadName << "\"}}";
+        }
+
+        for (size_t i = skipped; i < events.size(); i++) {
+            const TraceEvent& event = events[i];
+            separator();
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase
+                << "\",\"ts\":" << event.timestampUs << ",\"pid\":1,\"tid\":" << buffer->threadId;
+            if (event.phase == 'X') {
+                out << ",\"dur\":" << event.durationUs;
+            } else {
+                out << ",\"s\":\"t\"";
+            }
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Opt-in recorder for hot-path spans, exported as Chrome trace-event JSON
+// (loadable in chrome://tracing and ui.perfetto.dev).
+//
+// Each thread writes into its own fixed-size ring buffer, so recording never
+// locks or allocates after the first event on a thread. When tracing is off,
+// every trace site costs one relaxed load and a branch.
+//
+// Only the owning thread ever writes a buffer. Clearing bumps a generation
+// that each thread checks on its next append, and readers copy a buffer then
+// discard whatever the owner may have overwritten meanwhile.
+//
+// Event names must be string literals; only the pointer is stored.
+class TraceRecorder {
+public:
+    static const int EVENTS_PER_THREAD = 8192;
+
+    static bool IsEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // Enabling clears previously recorded events (lazily, per thread)
+    static void SetEnabled(bool isEnabled);
+
+    // Names the calling thread in the exported trace
+    static void SetThreadName(const char* name);
+
+    static void RecordSpan(const char* name, long long startUs, long long endUs);
+    static void RecordInstant(const char* name);
+
+    // Writes every buffered event as Chrome trace JSON. Safe while recording;
+    // events overwritten during the copy are left out.
+    static bool WriteChromeTrace(const std::string& path);
+
+    static long long NowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+private:
+    static std::atomic<bool> enabled;
+    static std::atomic<uint32_t> generation;
+};
+
+// Records a complete ("X") event covering the enclosing scope
+class TraceScope {
+public:
+    // Decided once here, so a disabled scope costs a single branch on each end
+    explicit TraceScope(const char* name)
+        : name(name),
+          isRecording(TraceRecorder::IsEnabled()),
+          startUs(isRecording ? TraceRecorder::NowMicros() : 0) {}
+
+    ~TraceScope() {
+        if (isRecording) {
+            TraceRecorder::RecordSpan(name, startUs, TraceRecorder::NowMicros());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    bool isRecording;
+    long long startUs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+
+#define TRACE_INSTANT(name)                      \
+    do {                                         \
+        if (TraceRecorder::IsEnabled()) {        \
+            TraceRecorder::RecordInstant(name);  \
+        }                                        \
+    } while (0)
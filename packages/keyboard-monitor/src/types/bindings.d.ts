@@ -1,12 +1,17 @@
-import type { KeyboardConfig, KeyboardFrame } from './keyboard';
+import type { KeyboardConfig, KeyboardEventArgs, PipelineStageStats } from './keyboard';
 
 declare module 'bindings' {
   interface NativeModule {
     KeyboardMonitor: {
-      new (callback: (eventName: string, data: KeyboardFrame) => void): {
+      new (callback: (...args: KeyboardEventArgs) => void): {
         start(): void;
         stop(): void;
-        setConfig(config: KeyboardConfig): void;
+        setConfig(config: KeyboardConfig, replace?: boolean): void;
+        getHoldDuration(key: string): number;
+        getPipelineStats(): PipelineStageStats[];
+        writeTrace(path: string): boolean;
+        saveCompiledConfig(path: string, hash: string): boolean;
+        loadCompiledConfig(path: string, hash: string): boolean;
       };
     };
   }
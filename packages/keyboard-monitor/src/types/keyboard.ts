@@ -30,8 +30,92 @@ export interface KeyboardFrame {
   gateOpen: boolean;
 }
 
+/**
+ * Emitted once per registered threshold when a key has been held that long
+ */
+export interface HoldEvent {
+  key: string;
+  thresholdMs: number;
+  heldMs: number;
+}
+
+/**
+ * Emitted when a key press completes a registered chord
+ */
+export interface ChordEvent {
+  id: number;
+  key: string;
+}
+
+/**
+ * Speculative move recognition: 'start' fires on the completing transition,
+ * then exactly one of 'confirm' or 'cancel' once the speculation window closes
+ */
+export type MovePhase = 'start' | 'confirm' | 'cancel';
+
+export interface MoveEvent {
+  name: string;
+  phase: MovePhase;
+  timestamp: number;
+}
+
+/**
+ * Payloads for each event the native module emits
+ */
+export interface KeyboardEventMap {
+  frame: KeyboardFrame;
+  hold: HoldEvent;
+  chord: ChordEvent;
+  move: MoveEvent;
+}
+
+export type KeyboardEventArgs = {
+  [K in keyof KeyboardEventMap]: [eventName: K, data: KeyboardEventMap[K]];
+}[keyof KeyboardEventMap];
+
 export type CapsLockBehavior = 'None' | 'DoublePress' | 'BlockToggle';
 
+/**
+ * Thread a pipeline stage runs on. Capture, chords, moves and filter always
+ * run on the capture thread; the frame builder and sinks can be
+ * offloaded to a worker.
+ */
+export type StagePlacement = 'capture' | 'worker';
+
+export interface PipelineConfig {
+  frameBuilder?: StagePlacement;
+  sinks?: StagePlacement;
+}
+
+export interface PipelineStageStats {
+  stage: string;
+  placement: StagePlacement;
+  processed: number;
+  dropped: number;
+}
+
+export interface ChordBindingConfig {
+  id: number;
+  keys: string[]; // every key that must be held, trigger included
+  trigger?: string; // defaults to the last entry in keys
+  forbidden?: string[]; // keys that must not be held
+}
+
+export interface MoveStepConfig {
+  type: 'press' | 'hold';
+  keys: string[];
+  minHoldMs?: number;
+  maxHoldMs?: number;
+  maxGapMs?: number;
+  multiPressToleranceMs?: number;
+  completeOnReleaseAfterMinHold?: boolean;
+}
+
+export interface MoveConfig {
+  name: string;
+  steps: MoveStepConfig[];
+}
+
 export interface RemapRule {
   from: string;
   to: string[];
@@ -43,13 +127,21 @@ export interface RemapValidationError {
   rule?: RemapRule;
 }
 
+/**
+ * Outcome of KeyboardMonitor.applyConfig
+ */
+export interface ConfigApplyResult {
+  fromCache: boolean; // a cached compiled image was mapped instead of parsing
+  errors: RemapValidationError[];
+}
+
 /**
  * Configuration for the keyboard monitor
  */
 export interface KeyboardConfig {
   // Feature flags
   isEnabled: boolean;
-  isRemapperEnabled: boolean;
+  isRemapperEnabled: boolean; // remaps need a hook source; polled keys are never remapped
 
   // Remapping configuration
   remaps: Record<string, string[]>;
@@ -63,4 +155,22 @@ export interface KeyboardConfig {
 
   // Gate configuration
   gateTimeout: number; // Time in ms to keep gate open after last key event
+
+  // Hold thresholds in ms per key name; each fires a 'hold' event once per press
+  holdThresholds?: Record<string, number | number[]>;
+
+  // Chord bindings; each fires a 'chord' event with its id when matched
+  chords?: ChordBindingConfig[];
+
+  // Moves recognized natively on raw transitions; each emits 'move' events
+  moves?: MoveConfig[];
+
+  // How long a recognized move stays provisional (ms); defaults to one frame
+  moveSpeculationWindowMs?: number;
+
+  // Stage placement; takes effect the next time the monitor starts
+  pipeline?: PipelineConfig;
+
+  // Record native hot-path spans for writeTrace(); clears the buffers when enabled
+  tracing?: boolean;
 }
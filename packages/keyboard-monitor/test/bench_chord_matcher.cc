@@ -0,0 +1,96 @@
+// Measures ChordMatcher::Match against registry size and cross-checks every
+// match against a brute-force scan of the bindings.
+//
+//   bench_chord_matcher
+
+#include "chord_matcher.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+    const uint32_t MODIFIERS[] = {0x10, 0x11, 0x12, 0x5B, 0x14};  // Shift, Control, Alt, Win, CapsLock
+    const uint32_t FIRST_TRIGGER = 0x30;
+    const uint32_t TRIGGER_COUNT = 90;
+
+    std::vector<ChordBinding> MakeBindings(int count, std::mt19937& rng) {
+        std::vector<ChordBinding> bindings;
+        bindings.reserve(count);
+        for (int i = 0; i < count; i++) {
+            ChordBinding binding{};
+            binding.id = i;
+            binding.triggerVk = FIRST_TRIGGER + rng() % TRIGGER_COUNT;
+
+            uint32_t modifierBits = rng() % 32;
+            for (int m = 0; m < 5; m++) {
+                if (modifierBits >> m & 1) binding.required.Set(MODIFIERS[m]);
+            }
+            if (rng() % 4 == 0) binding.required.Set(FIRST_TRIGGER + rng() % TRIGGER_COUNT);
+            if (rng() % 8 == 0) binding.forbidden.Set(MODIFIERS[rng() % 5]);
+            binding.required.Set(binding.triggerVk);
+            binding.forbidden.AndNot(binding.required);
+            bindings.push_back(binding);
+        }
+        return bindings;
+    }
+
+    int BruteForceMatch(const std::vector<ChordBinding>& bindings, uint32_t triggerVk, const KeySnapshot& held) {
+        int matches = 0;
+        for (const ChordBinding& binding : bindings) {
+            if (binding.triggerVk == triggerVk && binding.required.IsSubsetOf(held) &&
+                !binding.forbidden.Intersects(held)) {
+                matches++;
+            }
+        }
+        return matches;
+    }
+}
+
+int main() {
+    const int ITERATIONS = 2000000;
+    int mismatches = 0;
+
+    for (int bindingCount : {10, 100, 1000, 10000}) {
+        std::mt19937 rng(42);
+        std::vector<ChordBinding> bindings = MakeBindings(bindingCount, rng);
+
+        ChordMatcher matcher;
+        matcher.Build(bindings);
+
+        // Control + CapsLock + A held, then every trigger pressed in turn
+        KeySnapshot held;
+        held.Set(0x11);
+        held.Set(0x14);
+        held.Set('A');
+
+        volatile long sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; i++) {
+            uint32_t triggerVk = FIRST_TRIGGER + i % TRIGGER_COUNT;
+            held.Set(triggerVk);
+            sink += matcher.Match(triggerVk, held, [&sink](uint32_t id) { sink += id; });
+            if (triggerVk != 'A') held.Reset(triggerVk);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        long hits = 0;
+        for (uint32_t triggerVk = FIRST_TRIGGER; triggerVk < FIRST_TRIGGER + TRIGGER_COUNT; triggerVk++) {
+            KeySnapshot pressed = held;
+            pressed.Set(triggerVk);
+            int matches = matcher.Match(triggerVk, pressed, [](uint32_t) {});
+            if (matches != BruteForceMatch(bindings, triggerVk, pressed)) mismatches++;
+            hits += matches;
+        }
+
+        printf("%6d bindings: %7.1f ns/match, %.2f matches per press\n", bindingCount,
+            std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS,
+            static_cast<double>(hits) / TRIGGER_COUNT);
+    }
+
+    if (mismatches) {
+        printf("%d trigger(s) disagreed with the brute-force scan\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,570 @@
+// Soak test for the portable native core: RemapTable, KeyStateTable,
+// HoldTimerQueue, ChordMatcher, MoveRecognizer, DiffKeySnapshots, the worker
+// queue resync, trace export and the compiled config image. Checks a few behaviors directly, then drives
+// millions of random transitions through those pieces in capture-thread order
+// and asserts nothing allocates after warm-up.
+
+#include "chord_matcher.h"
+#include "compiled_config.h"
+#include "hold_timers.h"
+#include "input_pipeline.h"
+#include "key_names.h"
+#include "key_snapshot.h"
+#include "key_state_table.h"
+#include "move_recognizer.h"
+#include "trace_events.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    size_t allocationCount = 0;
+    int failureCount = 0;
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            printf("FAIL: %s\n", what);
+            failureCount++;
+        }
+    }
+}
+
+// Replace the whole scalar and array set so every allocation is counted and
+// every deallocation goes back through the same pair of helpers
+namespace {
+    void* CountedAllocate(size_t size) {
+        allocationCount++;
+        if (void* block = malloc(size ? size : 1)) return block;
+        throw std::bad_alloc();
+    }
+
+    void CountedRelease(void* block) noexcept {
+        free(block);
+    }
+}
+
+void* operator new(size_t size) { return CountedAllocate(size); }
+void* operator new[](size_t size) { return CountedAllocate(size); }
+void operator delete(void* block) noexcept { CountedRelease(block); }
+void operator delete[](void* block) noexcept { CountedRelease(block); }
+void operator delete(void* block, size_t) noexcept { CountedRelease(block); }
+void operator delete[](void* block, size_t) noexcept { CountedRelease(block); }
+
+namespace {
+    void TestRemapTable() {
+        RemapTable table;
+        table.Build({
+            {0x14, {0xA0}},
+            {'A', {0xA2, 'C'}},
+            {'B', {1, 2, 3, 4, 5, 6, 7, 8, 9, 10}},
+            {'A', {'Z'}},        // duplicate source; first entry wins
+            {300, {'X'}},        // out of range source
+            {'D', {0, 256}}      // no valid targets
+        });
+
+        uint32_t count = 0;
+        const uint8_t* targets = table.GetTargets('A', count);
+        Check(count == 2 && targets[0] == 0xA2 && targets[1] == 'C', "remap targets keep config order");
+        table.GetTargets('B', count);
+        Check(count == RemapTable::MAX_TARGETS, "remap targets truncated to MAX_TARGETS");
+        Check(table.HasRemap(0x14), "CapsLock remap present");
+        Check(!table.HasRemap('D') && !table.HasRemap(300), "invalid entries dropped");
+
+        table.Build({{'E', {'F'}}});
+        Check(!table.HasRemap('A') && table.HasRemap('E'), "rebuild replaces previous entries");
+    }
+
+    void TestHoldThresholds() {
+        std::vector<uint32_t> fired;
+        auto record = [&fired](const HoldReached& reached) { fired.push_back(reached.thresholdMs); };
+
+        HoldTimerQueue holds;
+        holds.SetThresholds('A', {100, 50, 200, 50}, 0);
+        holds.OnKeyPressed('A', 1000);
+        holds.OnKeyPressed('A', 1020);  // auto-repeat keeps the first press time
+        holds.Expire(1120, record);
+        Check(fired == std::vector<uint32_t>({50, 100}), "thresholds fire sorted and deduplicated");
+
+        // Re-applying config while held resumes after the crossed thresholds
+        fired.clear();
+        holds.ClearThresholds();
+        holds.SetThresholds('A', {50, 100, 200}, 1151);
+        holds.Expire(1151, record);
+        Check(fired.empty(), "crossed thresholds don't re-fire on reapply");
+        holds.Expire(1200, record);
+        Check(fired == std::vector<uint32_t>({200}), "remaining threshold fires after reapply");
+
+        holds.OnKeyReleased('A');
+        Check(holds.PendingCount() == 0 && holds.GetHoldDuration('A', 1300) == -1, "release clears the key");
+    }
+
+    void TestSnapshotDiff() {
+        KeySnapshot mask;
+        for (uint32_t vk = 8; vk < 0xE0; vk++) mask.Set(vk);
+
+        KeySnapshot previous, current;
+        previous.Set('A');
+        previous.Set(0x10);
+        current.Set('A');
+        current.Set('B');
+        current.Set(0xF0);  // outside the mask
+
+        KeySnapshotDiff diff;
+        Check(DiffKeySnapshots(previous, current, mask, diff), "diff reports changes");
+
+        std::vector<uint32_t> pressed, released;
+        ForEachKey(diff.pressed, [&pressed](uint32_t vk) { pressed.push_back(vk); });
+        ForEachKey(diff.released, [&released](uint32_t vk) { released.push_back(vk); });
+        Check(pressed == std::vector<uint32_t>({'B'}), "masked press reported");
+        Check(released == std::vector<uint32_t>({0x10}), "release reported");
+        Check(!DiffKeySnapshots(current, current, mask, diff), "identical snapshots report no change");
+    }
+
+    // The capture thread keeps pushing while the worker is stalled; the queue
+    // drops the overflow and the builder must catch up from the tick's heldKeys
+    void TestQueueOverflowResync() {
+        KeySnapshot mask;
+        for (uint32_t vk = 8; vk < 0xE0; vk++) mask.Set(vk);
+
+        BoundedQueue<KeyInputEvent, 8> queue;
+        KeySnapshot dispatched, builderHeld;
+        auto dispatch = [&](uint32_t vk, bool isKeyDown) {
+            if (isKeyDown) dispatched.Set(vk);
+            else dispatched.Reset(vk);
+            queue.TryPush(KeyInputEvent{vk, isKeyDown, 0});
+        };
+
+        // 'A' and 'B' reach the builder; everything after the eighth push is dropped
+        dispatch('A', true);
+        dispatch('B', true);
+        for (uint32_t vk = 'C'; vk < 'C' + 6; vk++) dispatch(vk, true);
+        dispatch('A', false);  // dropped: the builder still holds 'A'
+        dispatch('X', true);   // dropped: the builder never sees 'X'
+        dispatch('C', false);  // dropped
+        Check(queue.counters.dropped.load() == 3, "full queue rejects pushes");
+
+        KeyInputEvent event;
+        while (queue.TryPop(event)) {
+            if (event.isKeyDown) builderHeld.Set(event.vkCode);
+            else builderHeld.Reset(event.vkCode);
+        }
+        Check(builderHeld != dispatched, "builder is out of sync after the overflow");
+
+        std::vector<std::pair<uint32_t, bool>> replayed;
+        bool isResynced = ResyncHeldKeys(builderHeld, dispatched, mask, [&](uint32_t vk, bool isKeyDown) {
+            replayed.push_back({vk, isKeyDown});
+            if (isKeyDown) builderHeld.Set(vk);
+            else builderHeld.Reset(vk);
+        });
+        Check(isResynced && builderHeld == dispatched, "resync restores the dispatched held set");
+        Check(replayed == std::vector<std::pair<uint32_t, bool>>({{'A', false}, {'C', false}, {'X', true}}),
+            "resync replays releases before presses");
+        Check(!ResyncHeldKeys(builderHeld, dispatched, mask, [](uint32_t, bool) {}),
+            "nothing to replay once in sync");
+    }
+
+    // Every match the index reports must be exactly what a scan of the
+    // bindings finds, on both the subset-lookup and bucket-scan paths
+    void TestChordMatcher() {
+        const uint32_t MODIFIERS[] = {0x10, 0x11, 0x12, 0x5B, 0x14};
+        const uint32_t FIRST_TRIGGER = 'A';
+        const uint32_t TRIGGER_COUNT = 8;
+        std::mt19937 rng(31);
+
+        int mismatches = 0;
+        for (int bindingCount : {4, 64, 4000}) {
+            std::vector<ChordBinding> bindings;
+            for (int i = 0; i < bindingCount; i++) {
+                ChordBinding binding{};
+                binding.id = i;
+                binding.triggerVk = FIRST_TRIGGER + rng() % TRIGGER_COUNT;
+                for (uint32_t modifier : MODIFIERS) {
+                    if (rng() % 3 == 0) binding.required.Set(modifier);
+                }
+                if (rng() % 4 == 0) binding.required.Set(FIRST_TRIGGER + rng() % TRIGGER_COUNT);
+                if (rng() % 6 == 0) binding.forbidden.Set(MODIFIERS[rng() % 5]);
+                binding.required.Set(binding.triggerVk);
+                binding.forbidden.AndNot(binding.required);
+                bindings.push_back(binding);
+            }
+            ChordBinding invalid{};
+            invalid.id = bindingCount;
+            invalid.required.Set(0x10);
+            bindings.push_back(invalid);  // triggerVk 0 is rejected
+
+            ChordMatcher matcher;
+            matcher.Build(bindings);
+            Check(matcher.Size() == static_cast<size_t>(bindingCount), "bindings without a trigger are dropped");
+
+            for (int press = 0; press < 2000; press++) {
+                KeySnapshot held;
+                for (uint32_t modifier : MODIFIERS) {
+                    if (rng() % 2) held.Set(modifier);
+                }
+                for (int extra = rng() % 3; extra > 0; extra--) held.Set(FIRST_TRIGGER + rng() % TRIGGER_COUNT);
+                uint32_t triggerVk = FIRST_TRIGGER + rng() % TRIGGER_COUNT;
+                held.Set(triggerVk);
+
+                std::vector<uint32_t> matched, expected;
+                matcher.Match(triggerVk, held, [&matched](uint32_t id) { matched.push_back(id); });
+                for (const ChordBinding& binding : bindings) {
+                    if (binding.triggerVk == triggerVk && binding.required.IsSubsetOf(held) &&
+                        !binding.forbidden.Intersects(held)) {
+                        expected.push_back(binding.id);
+                    }
+                }
+                std::sort(matched.begin(), matched.end());
+                mismatches += matched != expected;
+            }
+        }
+        Check(mismatches == 0, "chord matches agree with a brute-force scan");
+    }
+
+    void TestMoveRebuild() {
+        MoveSpec move;
+        move.name = "tap";
+        move.steps.resize(1);
+        move.steps[0].keys.Set('A');
+
+        MoveRecognizer recognizer;
+        recognizer.SetSpeculationWindow(16);
+        recognizer.Build({move});
+        recognizer.OnKey('A', true, 100);
+
+        std::vector<MovePhase> phases;
+        auto record = [&phases](const MoveSignal& signal) { phases.push_back(signal.phase); };
+        recognizer.Drain(record);
+        Check(phases == std::vector<MovePhase>({MovePhase::Started}), "move starts on the final press");
+
+        // A rebuild inside the window must not strand the provisional move
+        phases.clear();
+        recognizer.CancelPending(105);
+        recognizer.Drain(record);
+        recognizer.Build({move});
+        recognizer.Advance(200);
+        recognizer.Drain(record);
+        Check(phases == std::vector<MovePhase>({MovePhase::Cancelled}), "pending move cancelled before rebuild");
+    }
+
+    void TestCompiledConfigImage() {
+        CompiledConfig config;
+        config.remapNames = {{"Capital", {"LShift"}}, {"A", {"LControl", "C"}}};
+        config.maxRemapChainLength = 1;
+        config.remaps = {{0x14, {0xA0}}, {'A', {0xA2, 'C'}}};
+        config.holdThresholds = {{'A', {200, 500}}};
+        config.frameTimeMicros = 8333;
+        config.isRemapperEnabled = true;
+
+        std::vector<uint8_t> image;
+        CompiledConfigImage::Write(config, "hash", image);
+
+        // A partial setConfig after a cache hit recompiles from these fields
+        CompiledConfig loaded;
+        Check(CompiledConfigImage::Read(image.data(), image.size(), "hash", loaded), "image reads back");
+        Check(loaded.remapNames == config.remapNames && loaded.maxRemapChainLength == 1,
+            "remap source survives the image");
+        Check(loaded.remaps == config.remaps && loaded.holdThresholds == config.holdThresholds &&
+            loaded.frameTimeMicros == 8333 && loaded.isRemapperEnabled, "compiled fields survive the image");
+
+        Check(!CompiledConfigImage::Read(image.data(), image.size(), "other", loaded), "wrong hash rejected");
+
+        // An image from a build with a different key-name table is stale even for the same config
+        std::vector<uint8_t> otherBuild = image;
+        otherBuild[offsetof(CompiledConfigImage::Header, keyTableHash)] ^= 1;
+        Check(!CompiledConfigImage::Read(otherBuild.data(), otherBuild.size(), "hash", loaded),
+            "other key-name table rejected");
+        image.back() ^= 1;
+        Check(!CompiledConfigImage::Read(image.data(), image.size(), "hash", loaded), "corrupt payload rejected");
+    }
+
+    // Minimal JSON syntax check: one value, then only whitespace
+    class JsonValidator {
+    public:
+        explicit JsonValidator(const std::string& text) : text(text) {}
+
+        bool IsValid() {
+            return Value() && (SkipSpace(), position == text.size());
+        }
+
+    private:
+        const std::string& text;
+        size_t position = 0;
+
+        void SkipSpace() {
+            while (position < text.size() && strchr(" \t\r\n", text[position])) position++;
+        }
+
+        bool Eat(char c) {
+            SkipSpace();
+            if (position < text.size() && text[position] == c) {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        bool String() {
+            if (!Eat('"')) return false;
+            while (position < text.size() && text[position] != '"') {
+                if (text[position] == '\\') position++;
+                position++;
+            }
+            return position++ < text.size();
+        }
+
+        bool Number() {
+            size_t start = position;
+            while (position < text.size() && strchr("-+.eE0123456789", text[position])) position++;
+            return position > start;
+        }
+
+        template <typename Element>
+        bool List(char open, char close, Element&& element) {
+            if (!Eat(open)) return false;
+            if (Eat(close)) return true;
+            do {
+                if (!element()) return false;
+            } while (Eat(','));
+            return Eat(close);
+        }
+
+        bool Value() {
+            SkipSpace();
+            if (position >= text.size()) return false;
+            switch (text[position]) {
+                case '{':
+                    return List('{', '}', [this]() { return String() && Eat(':') && Value(); });
+                case '[':
+                    return List('[', ']', [this]() { return Value(); });
+                case '"':
+                    return String();
+                default:
+                    return Number();
+            }
+        }
+    };
+
+    size_t CountOccurrences(const std::string& text, const std::string& needle) {
+        size_t count = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) count++;
+        return count;
+    }
+
+    // Two recording threads plus the main thread, then a clear, then export:
+    // the JSON must parse and hold only post-clear events
+    void TestTraceExport() {
+        const int EVENTS_PER_THREAD = 100;
+        auto record = [](const char* threadName, const char* spanName, const char* instantName, int count) {
+            TraceRecorder::SetThreadName(threadName);
+            for (int i = 0; i < count; i++) {
+                TraceScope scope(spanName);
+                TRACE_INSTANT(instantName);
+            }
+        };
+
+        TraceRecorder::SetEnabled(true);
+        std::thread firstBefore(record, "first", "BeforeSpan", "BeforeInstant", EVENTS_PER_THREAD);
+        std::thread secondBefore(record, "second", "BeforeSpan", "BeforeInstant", EVENTS_PER_THREAD);
+        record("main", "BeforeSpan", "BeforeInstant", EVENTS_PER_THREAD);
+        firstBefore.join();
+        secondBefore.join();
+
+        // Disabled scopes record nothing
+        TraceRecorder::SetEnabled(false);
+        record("main", "DisabledSpan", "DisabledInstant", EVENTS_PER_THREAD);
+
+        // Re-enabling clears; the main thread's buffer is reset on its next append
+        TraceRecorder::SetEnabled(true);
+        std::thread firstAfter(record, "first", "AfterSpan", "AfterInstant", EVENTS_PER_THREAD);
+        std::thread secondAfter(record, "second", "AfterSpan", "AfterInstant", EVENTS_PER_THREAD);
+        record("main", "AfterSpan", "AfterInstant", EVENTS_PER_THREAD);
+        firstAfter.join();
+        secondAfter.join();
+        TraceRecorder::SetEnabled(false);
+
+        const char* path = "core_test_trace.json";
+        Check(TraceRecorder::WriteChromeTrace(path), "trace export succeeds");
+        std::ifstream in(path);
+        std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        remove(path);
+
+        Check(JsonValidator(json).IsValid(), "trace export is well-formed JSON");
+        Check(json.find("Before") == std::string::npos && json.find("Disabled") == std::string::npos,
+            "no events from before the clear or while disabled");
+        Check(CountOccurrences(json, "\"AfterSpan\"") == 3 * EVENTS_PER_THREAD &&
+              CountOccurrences(json, "\"AfterInstant\"") == 3 * EVENTS_PER_THREAD,
+            "every post-clear event exported");
+    }
+
+    // Mirrors a capture-thread poll: diff, then every transition runs through
+    // the portable stages in pipeline order (chords, moves, remap)
+    // and into the frame-builder state (key states, hold timers). The
+    // warm-up is checked against simple models before allocations are counted.
+    void TestSoak() {
+        const long WARMUP_EVENTS = 10000;
+        const long SOAK_EVENTS = 5000000;
+        const uint32_t CAPS = 0x14, SHIFT = 0x10, F1 = 0x70, SPACE = 0x20;
+
+        auto makeChord = [](uint32_t id, std::initializer_list<uint32_t> required, uint32_t forbiddenVk) {
+            ChordBinding chord{};
+            chord.id = id;
+            for (uint32_t vk : required) {
+                chord.required.Set(vk);
+                chord.triggerVk = vk;
+            }
+            if (forbiddenVk) chord.forbidden.Set(forbiddenVk);
+            return chord;
+        };
+        std::vector<ChordBinding> chords = {
+            makeChord(0, {CAPS, 'A'}, 0),
+            makeChord(1, {CAPS, SHIFT, 'B'}, 0),
+            makeChord(2, {'C'}, SHIFT),
+            makeChord(3, {CAPS, 'A', SPACE}, 'B')
+        };
+        ChordMatcher matcher;
+        matcher.Build(chords);
+
+        auto makeStep = [](MoveStepType type, std::initializer_list<uint32_t> keys, int minHoldMs, int maxGapMs) {
+            MoveStepSpec step;
+            step.type = type;
+            for (uint32_t vk : keys) step.keys.Set(vk);
+            step.minHoldMs = minHoldMs;
+            step.maxGapMs = maxGapMs;
+            return step;
+        };
+        MoveSpec tapTap{"tap-tap", {makeStep(MoveStepType::Press, {'A'}, 0, 0),
+                                    makeStep(MoveStepType::Press, {'B'}, 0, 200)}};
+        MoveSpec charge{"charge", {makeStep(MoveStepType::Hold, {CAPS}, 100, 0),
+                                   makeStep(MoveStepType::Press, {'C'}, 0, 300)}};
+        MoveRecognizer moves;
+        moves.SetSpeculationWindow(16);
+        moves.Build({tapTap, charge});
+
+        RemapTable remaps;
+        remaps.Build({{CAPS, {0xA0}}, {'A', {0xA2, 'C'}}, {F1, {0xA4, 0x09}}});
+
+        HoldTimerQueue holds;
+        holds.SetThresholds('A', {200, 500}, 0);
+        holds.SetThresholds(CAPS, {150}, 0);
+
+        KeyStateTable keyStates;
+        KeySnapshot mask = KeyNames::BuildCaptureMask();
+        KeySnapshot polled, chordHeld;
+
+        const uint32_t keys[] = {CAPS, 'A', F1, 'B', 'C', SPACE, SHIFT, 0xF0};
+        std::mt19937 rng(7);
+        long long nowMs = 0;
+        size_t chordsMatched = 0, moveSignals = 0, holdsFired = 0, remapped = 0, transitions = 0;
+        bool isModelChecked = true;
+        std::set<uint32_t> model;
+
+        auto run = [&](long eventCount, bool isModelled) {
+            for (long i = 0; i < eventCount; i++) {
+                nowMs += rng() % 20;
+                uint32_t vk = keys[rng() % (sizeof(keys) / sizeof(keys[0]))];
+                moves.Advance(nowMs);
+
+                // The test input toggles unmasked keys too; the source only diffs masked ones
+                KeySnapshot snapshot = polled;
+                snapshot.Toggle(vk);
+
+                KeySnapshotDiff diff;
+                if (DiffKeySnapshots(polled, snapshot, mask, diff)) {
+                    auto process = [&](uint32_t key, bool isKeyDown) {
+                        transitions++;
+
+                        // Chords: first press only, trigger must be in held
+                        if (isKeyDown && !chordHeld.Test(key)) {
+                            chordHeld.Set(key);
+                            int matches = matcher.Match(key, chordHeld, [](uint32_t) {});
+                            chordsMatched += matches;
+                            if (isModelled) {
+                                int expected = 0;
+                                for (const ChordBinding& chord : chords) {
+                                    expected += chord.triggerVk == key && chord.required.IsSubsetOf(chordHeld) &&
+                                                !chord.forbidden.Intersects(chordHeld);
+                                }
+                                isModelChecked &= matches == expected;
+                            }
+                        } else if (!isKeyDown) {
+                            chordHeld.Reset(key);
+                        }
+
+                        moves.OnKey(key, isKeyDown, nowMs);
+
+                        // Remap, then the frame-builder side
+                        uint32_t count = 0;
+                        const uint8_t* targets = remaps.GetTargets(key, count);
+                        remapped += count != 0;
+                        if (isKeyDown) {
+                            keyStates.Press(key, false, nowMs, targets, count);
+                            holds.OnKeyPressed(key, nowMs);
+                        } else {
+                            keyStates.Release(key);
+                            holds.OnKeyReleased(key);
+                        }
+                    };
+                    ForEachKey(diff.released, [&process](uint32_t key) { process(key, false); });
+                    ForEachKey(diff.pressed, [&process](uint32_t key) { process(key, true); });
+                    polled |= diff.pressed;
+                    polled.AndNot(diff.released);
+                }
+
+                moves.Drain([&moveSignals](const MoveSignal&) { moveSignals++; });
+                holds.Expire(nowMs, [&holdsFired](const HoldReached&) { holdsFired++; });
+
+                if (isModelled) {
+                    if (mask.Test(vk) && !model.erase(vk)) model.insert(vk);
+                    for (uint32_t key : keys) {
+                        isModelChecked &= polled.Test(key) == (model.count(key) != 0);
+                        isModelChecked &= keyStates.IsPressed(key) == polled.Test(key);
+                    }
+                }
+            }
+        };
+
+        run(WARMUP_EVENTS, true);
+        Check(isModelChecked, "snapshot state and chord matches agree with the models");
+
+        size_t allocationsBefore = allocationCount;
+        run(SOAK_EVENTS, false);
+        size_t allocations = allocationCount - allocationsBefore;
+
+        printf("soak: %ld events, %zu transitions, %zu chords, %zu move signals, %zu remaps, "
+            "%zu holds fired, %zu allocations\n",
+            SOAK_EVENTS, transitions, chordsMatched, moveSignals, remapped, holdsFired, allocations);
+        Check(allocations == 0, "no allocations after warm-up");
+        Check(chordsMatched > 0 && moveSignals > 0 && remapped > 0 && holdsFired > 0,
+            "every stage saw traffic during soak");
+    }
+}
+
+int main() {
+    TestRemapTable();
+    TestHoldThresholds();
+    TestSnapshotDiff();
+    TestQueueOverflowResync();
+    TestChordMatcher();
+    TestMoveRebuild();
+    TestCompiledConfigImage();
+    TestTraceExport();
+    TestSoak();
+
+    if (failureCount) {
+        printf("%d check(s) failed\n", failureCount);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}